@@ -18,8 +18,14 @@ public:
     void addBranch(unsigned ID, std::string filename, unsigned sourceLine, 
                    unsigned targetLine);
     void writeToFile(const std::string &filename);
+    void addPath(unsigned ID, std::string kind, std::string function,
+                 std::string filename, std::string blocks);
+    void writePathsToFile(const std::string &filename);
 private:
     std::map<unsigned, std::tuple<std::string, unsigned, unsigned>> branches;
+    std::map<unsigned,
+             std::tuple<std::string, std::string, std::string, std::string>>
+        paths;
 };
 
 class FunctionPointerLoggerPass : public PassInfoMixin<FunctionPointerLoggerPass> {
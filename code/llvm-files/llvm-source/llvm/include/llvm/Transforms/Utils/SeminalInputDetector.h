@@ -11,17 +11,64 @@
 #include <vector>
 
 #include "nlohmann/json.hpp"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/Passes/PassPlugin.h"
 
 namespace llvm {
 
+class BasicBlock;
+class DIType;
+class Instruction;
 
+/**
+ * Strips typedefs and cv-qualifiers (const, volatile, restrict, _Atomic) off
+ * a debug type, returning the underlying type.
+ */
+DIType *stripDebugQualifiers(DIType *Type);
+
+/**
+ * Control dependences of a function: block B is control dependent on the
+ * terminator of block A when one successor of A always leads to B but A
+ * itself is not post-dominated by B.
+ */
+class SeminalControlDependence {
+public:
+  /**
+   * Returns the terminators (branches, switches) that decide whether the
+   * block executes.
+   */
+  ArrayRef<Instruction *> getControllingTerminators(const BasicBlock *BB) const;
+
+  /**
+   * Records that a block is control dependent on a terminator.
+   */
+  void addDependence(const BasicBlock *BB, Instruction *Terminator);
+
+private:
+  DenseMap<const BasicBlock *, SmallVector<Instruction *, 2>> dependences;
+};
+
+/**
+ * Computes control dependence once per function from the post-dominator
+ * tree; cached by the FunctionAnalysisManager like any other analysis.
+ */
+class SeminalControlDependenceAnalysis
+    : public AnalysisInfoMixin<SeminalControlDependenceAnalysis> {
+  friend AnalysisInfoMixin<SeminalControlDependenceAnalysis>;
+  static AnalysisKey Key;
+
+public:
+  using Result = SeminalControlDependence;
+  Result run(Function &F, FunctionAnalysisManager &FAM);
+};
 
 class SeminalInputDetectorPass
     : public PassInfoMixin<SeminalInputDetectorPass> {
 public:
-  PreservedAnalyses run(Function &F, FunctionAnalysisManager &FAM);
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &MAM);
   static bool isRequired() { return true; }
   
 
@@ -30,4 +77,4 @@ public:
 
 } // namespace llvm
 
-#endif // SEMINAL_INPUT_DETECTOR_H
\ No newline at end of file
+#endif // SEMINAL_INPUT_DETECTOR_H
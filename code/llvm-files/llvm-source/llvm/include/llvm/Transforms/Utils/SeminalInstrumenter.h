@@ -0,0 +1,60 @@
+// SeminalInstrumenter.h
+
+#ifndef SEMINAL_INSTRUMENTER_H
+#define SEMINAL_INSTRUMENTER_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+class DIType;
+class DominatorTree;
+class Instruction;
+class LoopInfo;
+class PostDominatorTree;
+
+/**
+ * Finds where a program keeps a reported feature (`n`, `game.board[1][2]`):
+ * the alloca or global whose debug variable has the name and declaration
+ * line (0 matches any line), and the byte offset and debug type of the
+ * feature within it. Returns null if the variable is not in memory.
+ */
+Value *findFeatureStorage(Module &M, StringRef Name, unsigned Line,
+                          uint64_t *Offset, DIType **Type);
+
+/**
+ * Returns the point right after an instruction has completed: the next
+ * instruction, or, inside a loop, the exit of its outermost loop. Returns
+ * null if the loop's exits have no common post-dominator.
+ */
+Instruction *getCompletionPoint(Instruction *Inst, LoopInfo &LI,
+                                PostDominatorTree &PDT);
+
+/**
+ * Returns the earliest point of a function reached only after all the given
+ * points: one of them that all the others dominate, or, when they lie on
+ * different paths, the nearest block post-dominating them all. Returns null
+ * if no block post-dominates them.
+ */
+Instruction *findLatestPoint(ArrayRef<Instruction *> Points,
+                             DominatorTree &DT, PostDominatorTree &PDT);
+
+/**
+ * Instruments a program to snapshot its seminal features as soon as they are
+ * known. The features reported by the Seminal Input Detector are read back
+ * from its JSON output; in each function that reads them, a call is inserted
+ * at the earliest point dominated by all of those reads, writing the actual
+ * values (and the lengths of streams and buffers) to a side file or shared
+ * memory through the runtime in `code/runtime`.
+ */
+class SeminalInstrumenterPass : public PassInfoMixin<SeminalInstrumenterPass> {
+public:
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &MAM);
+  static bool isRequired() { return true; }
+};
+
+} // namespace llvm
+
+#endif // SEMINAL_INSTRUMENTER_H
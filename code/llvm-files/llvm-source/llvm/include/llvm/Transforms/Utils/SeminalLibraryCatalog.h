@@ -0,0 +1,119 @@
+// SeminalLibraryCatalog.h
+
+#ifndef SEMINAL_LIBRARY_CATALOG_H
+#define SEMINAL_LIBRARY_CATALOG_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/InstrTypes.h"
+
+namespace llvm {
+
+/**
+ * A part of a library call: its result or the memory it points to, or the
+ * value of or memory behind one or more of its arguments.
+ */
+struct SeminalEndpoint {
+  enum Kind { Ret, Arg, ArgsFrom, Mem, MemFrom, RetMem };
+
+  Kind kind;
+  unsigned index;
+
+  /** Returns true if the endpoint is the memory behind arguments. */
+  bool isMemory() const { return kind == Mem || kind == MemFrom; }
+
+  /** Returns true if the endpoint covers the memory behind argument ArgNo. */
+  bool coversMemory(unsigned ArgNo) const {
+    return (kind == Mem && index == ArgNo) ||
+           (kind == MemFrom && index <= ArgNo);
+  }
+
+  /**
+   * Returns the arguments of the call the endpoint covers; empty for Ret and
+   * RetMem.
+   */
+  SmallVector<Value *, 4> getArguments(const CallBase *Call) const;
+};
+
+/** Data moving from one endpoint of a library call to another. */
+struct SeminalFlow {
+  SeminalEndpoint from;
+  SeminalEndpoint to;
+};
+
+/** What the catalog knows about one library function. */
+struct SeminalLibraryModel {
+  /** Endpoints that receive external input. */
+  SmallVector<SeminalEndpoint, 2> sources;
+
+  /** How data moves through the call; empty for functions with no flow. */
+  SmallVector<SeminalFlow, 4> flows;
+
+  /** Arguments whose product is the size of the memory allocated. */
+  SmallVector<unsigned, 2> sizeArguments;
+
+  /** True if the function only writes output or waits. */
+  bool output = false;
+
+  /** Returns true if the function is an input source. */
+  bool isSource() const { return !sources.empty(); }
+
+  /** Returns true if the function allocates memory of a given size. */
+  bool isAllocation() const { return !sizeArguments.empty(); }
+
+  /**
+   * Returns true if the function may write memory behind its arguments or
+   * the memory it returns; calls that only produce a value cannot clobber a
+   * variable.
+   */
+  bool writesMemory() const;
+
+  /** Returns true if the function may write the memory behind an argument. */
+  bool writesArgument(unsigned ArgNo) const;
+
+  /**
+   * Returns true if the function fills the memory its result points to, as
+   * `strdup` fills the copy it allocates.
+   */
+  bool writesReturnedMemory() const;
+
+  /**
+   * Returns true if the function returns a new heap object: one it sizes
+   * from its arguments, or one it fills, like `strdup`'s copy.
+   */
+  bool returnsHeapMemory() const {
+    return isAllocation() || writesReturnedMemory();
+  }
+};
+
+/**
+ * The input sources and flow models of library functions, built once from
+ * SeminalLibraryCatalog.def and looked up by name in constant time.
+ */
+class SeminalLibraryCatalog {
+public:
+  /** Returns the catalog, loading it on first use. */
+  static const SeminalLibraryCatalog &get();
+
+  /**
+   * Returns the model of the called function, or null if the callee is
+   * unknown, indirect or defined in the module.
+   */
+  const SeminalLibraryModel *lookup(const CallBase *Call) const;
+
+  /**
+   * Strips the `__isoc99_` and `_IO_` prefixes and intrinsic suffixes, so
+   * `__isoc99_scanf` is `scanf` and `llvm.memcpy.p0.p0.i64` is `memcpy`.
+   */
+  static StringRef normalizeName(StringRef Name);
+
+private:
+  SeminalLibraryCatalog();
+
+  StringMap<SeminalLibraryModel> models;
+};
+
+} // namespace llvm
+
+#endif // SEMINAL_LIBRARY_CATALOG_H
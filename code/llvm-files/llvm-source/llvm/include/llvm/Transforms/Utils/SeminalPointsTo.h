@@ -0,0 +1,80 @@
+// SeminalPointsTo.h
+
+#ifndef SEMINAL_POINTS_TO_H
+#define SEMINAL_POINTS_TO_H
+
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+
+namespace llvm {
+
+/**
+ * Steensgaard-style, unification-based points-to analysis over a module.
+ *
+ * Every value that may hold an address gets a node; unifying two nodes also
+ * unifies what they point to, so each node has at most one pointee. A memory
+ * class is the pointee of some node and groups the memory objects (allocas,
+ * globals and heap allocation sites) that may be addressed through it.
+ * Union-find with path compression keeps construction near-linear in the
+ * size of the module.
+ */
+class SeminalPointsTo {
+public:
+  /** Returned for values the analysis has never seen. */
+  static constexpr unsigned NoClass = ~0u;
+
+  explicit SeminalPointsTo(Module &M);
+
+  /**
+   * Returns the memory class a pointer value may point into, or NoClass.
+   */
+  unsigned getMemoryClass(const Value *Ptr) const;
+
+  /**
+   * Returns the allocation sites (allocas, globals, heap calls) in a class.
+   */
+  ArrayRef<const Value *> getObjects(unsigned Class) const;
+
+  /**
+   * Returns the instructions that may write memory of a class: stores and
+   * calls that are handed a pointer into it.
+   */
+  ArrayRef<Instruction *> getWriters(unsigned Class) const;
+
+  /**
+   * Returns true if the allocation site allocates heap memory, as the
+   * library catalog models it.
+   */
+  static bool isHeapAllocation(const Value *V);
+
+private:
+  unsigned getNode(const Value *V);
+  unsigned getReturnNode(const Function *F);
+  unsigned getPointee(unsigned Node);
+  unsigned find(unsigned Node);
+  void join(unsigned A, unsigned B);
+
+  void addressOf(const Value *Ptr, const Value *Object);
+  void copy(const Value *Dst, const Value *Src);
+  void load(const Value *Dst, const Value *Ptr);
+  void store(const Value *Ptr, const Value *Src);
+  void visitCall(CallBase *Call, ArrayRef<Function *> AddressTaken);
+  void buildIndex(Module &M);
+
+  DenseMap<const Value *, unsigned> nodes;
+  DenseMap<const Function *, unsigned> returnNodes;
+  std::vector<unsigned> parent;
+  std::vector<unsigned> rank;
+  std::vector<unsigned> pointee;
+
+  DenseMap<unsigned, std::vector<const Value *>> objects;
+  DenseMap<unsigned, std::vector<Instruction *>> writers;
+};
+
+} // namespace llvm
+
+#endif // SEMINAL_POINTS_TO_H
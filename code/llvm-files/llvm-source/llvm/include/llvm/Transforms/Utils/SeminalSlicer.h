@@ -0,0 +1,26 @@
+// SeminalSlicer.h
+
+#ifndef SEMINAL_SLICER_H
+#define SEMINAL_SLICER_H
+
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+/**
+ * Reduces a program instrumented by the Seminal Instrumenter to a feature
+ * extractor. `main` stops as soon as its last snapshot is taken and prints
+ * the feature vector; what remains of it before that point is sliced down to
+ * the input reads and the computation the snapshot depends on. Output calls
+ * whose results are unused are dropped everywhere.
+ */
+class SeminalSlicerPass : public PassInfoMixin<SeminalSlicerPass> {
+public:
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &MAM);
+  static bool isRequired() { return true; }
+};
+
+} // namespace llvm
+
+#endif // SEMINAL_SLICER_H
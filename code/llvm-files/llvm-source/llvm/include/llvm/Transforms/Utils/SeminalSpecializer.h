@@ -0,0 +1,26 @@
+// SeminalSpecializer.h
+
+#ifndef SEMINAL_SPECIALIZER_H
+#define SEMINAL_SPECIALIZER_H
+
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+/**
+ * Specializes a program for the values its seminal inputs usually take.
+ * Hot values come from a value profile of feature snapshots; loops whose
+ * exits depend on a feature are versioned, and functions that receive one as
+ * an argument are cloned, each copy guarded by `feature == value` and
+ * running with the value as a constant. Code growth is bounded by a budget.
+ */
+class SeminalSpecializerPass : public PassInfoMixin<SeminalSpecializerPass> {
+public:
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &MAM);
+  static bool isRequired() { return true; }
+};
+
+} // namespace llvm
+
+#endif // SEMINAL_SPECIALIZER_H
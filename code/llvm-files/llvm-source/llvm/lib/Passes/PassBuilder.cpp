@@ -236,6 +236,9 @@
 #include "llvm/Transforms/Utils/FixIrreducible.h"
 #include "llvm/Transforms/Utils/FunctionPointerLogger.h"
 #include "llvm/Transforms/Utils/SeminalInputDetector.h"
+#include "llvm/Transforms/Utils/SeminalInstrumenter.h"
+#include "llvm/Transforms/Utils/SeminalSlicer.h"
+#include "llvm/Transforms/Utils/SeminalSpecializer.h"
 #include "llvm/Transforms/Utils/HelloWorld.h"
 #include "llvm/Transforms/Utils/InjectTLIMappings.h"
 #include "llvm/Transforms/Utils/InstructionNamer.h"
@@ -1,5 +1,11 @@
 #include "llvm/Transforms/Utils/FunctionPointerLogger.h"
 
+#include <set>
+#include <vector>
+
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+
 using namespace llvm;
 
 void BranchDictionary::addBranch(unsigned ID, std::string filename,
@@ -17,6 +23,98 @@ void BranchDictionary::writeToFile(const std::string &filename) {
   }
 }
 
+void BranchDictionary::addPath(unsigned ID, std::string kind,
+                               std::string function, std::string filename,
+                               std::string blocks) {
+  paths[ID] = std::make_tuple(kind, function, filename, blocks);
+}
+
+void BranchDictionary::writePathsToFile(const std::string &filename) {
+  std::error_code EC;
+  raw_fd_ostream OS(filename, EC);
+  for (const auto &entry : paths) {
+    OS << std::get<0>(entry.second) << "_" << entry.first << ": "
+       << std::get<1>(entry.second) << ", " << std::get<2>(entry.second)
+       << ", " << std::get<3>(entry.second) << "\n";
+  }
+}
+
+// Returns true if a call may run instrumented code, which logs events of its
+// own before the call returns: an indirect call or a call to a function
+// defined in the module
+static bool mayLogEvents(const CallInst *Call) {
+  if (isa<IntrinsicInst>(Call)) {
+    return false;
+  }
+  const Function *Callee = Call->getCalledFunction();
+  return !Callee || !Callee->isDeclaration();
+}
+
+// Describes the code that runs from Start until the next logged event, as
+// "bb<index>:<line>,<line>,..." separated by spaces: the rest of Start's
+// block, then the blocks reached through unconditional branches. It ends at
+// a conditional branch or switch (the edge taken is logged), at a return,
+// or at a call that may log events (its return is logged)
+static std::string describePath(Instruction *Start,
+                                const std::map<BasicBlock *, unsigned> &Index) {
+  std::string Path;
+  std::set<BasicBlock *> Visited = {Start->getParent()};
+  for (Instruction *Inst = Start; Inst;) {
+    BasicBlock *BB = Inst->getParent();
+    Path += (Path.empty() ? "bb" : " bb") + std::to_string(Index.at(BB)) + ":";
+    unsigned LastLine = 0;
+    bool First = true;
+    bool Called = false;
+    for (auto It = Inst->getIterator(); It != BB->end() && !Called; ++It) {
+      unsigned Line = It->getDebugLoc() ? It->getDebugLoc().getLine() : 0;
+      if (Line && Line != LastLine) {
+        Path += (First ? "" : ",") + std::to_string(Line);
+        LastLine = Line;
+        First = false;
+      }
+      auto *Call = dyn_cast<CallInst>(&*It);
+      Called = Call && mayLogEvents(Call);
+    }
+
+    auto *Br = dyn_cast<BranchInst>(BB->getTerminator());
+    Inst = !Called && Br && Br->isUnconditional() &&
+                   Visited.insert(Br->getSuccessor(0)).second
+               ? &Br->getSuccessor(0)->front()
+               : nullptr;
+  }
+  return Path;
+}
+
+// Returns the line of the first instruction of a block with debug info
+static unsigned getFirstLine(BasicBlock *BB) {
+  for (Instruction &Inst : *BB) {
+    if (Inst.getDebugLoc()) {
+      return Inst.getDebugLoc().getLine();
+    }
+  }
+  return 0;
+}
+
+// Moves an edge into a block of its own, so code placed there runs exactly
+// once each time the edge is taken, whatever other edges enter the target
+static BasicBlock *splitEdge(Instruction *Term, unsigned SuccNum) {
+  BasicBlock *From = Term->getParent();
+  BasicBlock *Dest = Term->getSuccessor(SuccNum);
+  BasicBlock *Edge = BasicBlock::Create(Term->getContext(), "fpl.edge",
+                                        From->getParent(), Dest);
+  BranchInst::Create(Dest, Edge);
+  Term->setSuccessor(SuccNum, Edge);
+
+  // A phi has one entry per edge, so each split takes over one of From's
+  for (PHINode &Phi : Dest->phis()) {
+    int Incoming = Phi.getBasicBlockIndex(From);
+    if (Incoming >= 0) {
+      Phi.setIncomingBlock(Incoming, Edge);
+    }
+  }
+  return Edge;
+}
+
 PreservedAnalyses FunctionPointerLoggerPass::run(Function &F,
                                                  FunctionAnalysisManager &AM) {
   Module *M = F.getParent();
@@ -40,12 +138,121 @@ PreservedAnalyses FunctionPointerLoggerPass::run(Function &F,
       FunctionType::get(Type::getInt32Ty(Ctx), {FilePtrTy}, false);
   FunctionCallee FClose = M->getOrInsertFunction("fclose", FCloseTy);
 
-  // Global FILE* variable
-  GlobalVariable *FilePtr =
-      new GlobalVariable(*M, FilePtrTy, false, GlobalValue::ExternalLinkage,
-                         ConstantPointerNull::get(FilePtrTy), "log_file");
+  // Global FILE* variable, shared by every function of the module and opened
+  // by main
+  Constant *FilePtr = M->getOrInsertGlobal("log_file", FilePtrTy, [&] {
+    return new GlobalVariable(*M, FilePtrTy, false,
+                              GlobalValue::ExternalLinkage,
+                              ConstantPointerNull::get(FilePtrTy), "log_file");
+  });
+
+  // Writes one event line, e.g. "br_3", before the builder's insertion point
+  auto LogEvent = [&](IRBuilder<> &Builder, const char *Format, unsigned ID) {
+    // Load FILE* from the global variable
+    Value *FileHandle = Builder.CreateLoad(FilePtrTy, FilePtr);
+    Value *FormatStr = Builder.CreateGlobalStringPtr(Format);
+    Builder.CreateCall(FPrintf,
+                       {FileHandle, FormatStr,
+                        ConstantInt::get(Type::getInt32Ty(Ctx), ID)});
+  };
+
+  // Functions without debug info are named after their subprogram's file
+  std::string FunctionFile =
+      F.getSubprogram() ? F.getSubprogram()->getFilename().str() : "?";
+
+  // Paths are described on the original blocks, before any are added
+  std::map<BasicBlock *, unsigned> Index;
+  unsigned NextIndex = 0;
+  for (BasicBlock &BB : F) {
+    Index[&BB] = NextIndex++;
+  }
 
-  // Open file at the entry point
+  // Every edge of a conditional branch or switch is logged as it is taken
+  struct Edge {
+    Instruction *Term;
+    unsigned SuccNum;
+    unsigned ID;
+  };
+  std::vector<Edge> Edges;
+  for (auto &BB : F) {
+    Instruction *Term = BB.getTerminator();
+    auto *Br = dyn_cast<BranchInst>(Term);
+    if ((!Br || !Br->isConditional()) && !isa<SwitchInst>(Term)) {
+      continue;
+    }
+
+    // Get source location info
+    const DebugLoc &DL = Term->getDebugLoc();
+    std::string Filename = DL ? DL->getFilename().str() : FunctionFile;
+    unsigned SourceLine = DL ? DL.getLine() : 0;
+
+    for (unsigned I = 0; I < Term->getNumSuccessors(); ++I) {
+      BasicBlock *Dest = Term->getSuccessor(I);
+      unsigned ID = nextBranchID++;
+      Edges.push_back({Term, I, ID});
+
+      // Add branch info to dictionary
+      branchDict.addBranch(ID, Filename, SourceLine, getFirstLine(Dest));
+      branchDict.addPath(ID, "br", F.getName().str(), Filename,
+                         describePath(&Dest->front(), Index));
+    }
+  }
+
+  // The code after a call that may log events resumes with a "ret" event
+  std::vector<std::pair<CallInst *, unsigned>> Returns;
+  std::vector<CallInst *> IndirectCalls;
+  for (Instruction &I : instructions(F)) {
+    auto *Call = dyn_cast<CallInst>(&I);
+    if (!Call) {
+      continue;
+    }
+    if (Call->isIndirectCall()) {
+      IndirectCalls.push_back(Call);
+    }
+    if (mayLogEvents(Call)) {
+      unsigned ID = nextBranchID++;
+      Returns.push_back({Call, ID});
+      branchDict.addPath(ID, "ret", F.getName().str(), FunctionFile,
+                         describePath(Call->getNextNode(), Index));
+    }
+  }
+
+  // The entry block runs before any edge is taken and is logged by "fn"
+  unsigned EntryID = nextBranchID++;
+  branchDict.addPath(EntryID, "fn", F.getName().str(), FunctionFile,
+                     describePath(&F.getEntryBlock().front(), Index));
+
+  for (CallInst *Call : IndirectCalls) {
+    IRBuilder<> Builder(Call);
+    Value *FuncPtr = Call->getCalledOperand();
+
+    // Load FILE* from the global variable
+    Value *FileHandle = Builder.CreateLoad(FilePtrTy, FilePtr);
+
+    // Create format string
+    Value *FormatStr = Builder.CreateGlobalStringPtr("*func_%p\n");
+
+    // Create fprintf call
+    Builder.CreateCall(FPrintf, {FileHandle, FormatStr, FuncPtr});
+  }
+
+  for (auto &Return : Returns) {
+    IRBuilder<> Builder(Return.first->getNextNode());
+    LogEvent(Builder, "ret_%d\n", Return.second);
+  }
+
+  for (const Edge &E : Edges) {
+    BasicBlock *Block = splitEdge(E.Term, E.SuccNum);
+    IRBuilder<> Builder(Block->getTerminator());
+    LogEvent(Builder, "br_%d\n", E.ID);
+  }
+
+  {
+    IRBuilder<> Builder(&*F.getEntryBlock().getFirstInsertionPt());
+    LogEvent(Builder, "fn_%d\n", EntryID);
+  }
+
+  // Open file at the entry point, before the entry is logged
   if (F.getName() == "main") {
     IRBuilder<> Builder(&*F.getEntryBlock().getFirstInsertionPt());
     Value *FileName = Builder.CreateGlobalString("branch-pointer_trace.txt");
@@ -54,93 +261,6 @@ PreservedAnalyses FunctionPointerLoggerPass::run(Function &F,
     Builder.CreateStore(FileHandle, FilePtr);
   }
 
-  for (auto &BB : F) {
-    for (auto &I : BB) {
-      if (auto *Call = dyn_cast<CallInst>(&I)) {
-        if (Call->isIndirectCall()) {
-          IRBuilder<> Builder(Call);
-          Value *FuncPtr = Call->getCalledOperand();
-
-          // Load FILE* from the global variable
-          Value *FileHandle = Builder.CreateLoad(FilePtrTy, FilePtr);
-
-          // Create format string
-          Value *FormatStr = Builder.CreateGlobalStringPtr("*func_%p\n");
-
-          // Create fprintf call
-          Builder.CreateCall(FPrintf, {FileHandle, FormatStr, FuncPtr});
-        }
-      } else if (auto *Br = dyn_cast<BranchInst>(&I)) {
-        if (Br->isConditional()) {
-          const DebugLoc &DL = Br->getDebugLoc();
-          if (DL) {
-            // Get source location info
-            StringRef Filename = DL->getFilename();
-            unsigned SourceLine = DL.getLine();
-
-            // Get branch IDs
-            unsigned TrueBranchID = nextBranchID++;
-            unsigned FalseBranchID = nextBranchID++;
-
-            // Get target basic blocks
-            BasicBlock *TrueDest = Br->getSuccessor(0);
-            BasicBlock *FalseDest = Br->getSuccessor(1);
-
-            // Insert logging in TrueDest
-            {
-              IRBuilder<> Builder(&*TrueDest->getFirstInsertionPt());
-              // Load FILE* from the global variable
-              Value *FileHandle = Builder.CreateLoad(FilePtrTy, FilePtr);
-              Value *FormatStr = Builder.CreateGlobalStringPtr("br_%d\n");
-              Builder.CreateCall(
-                  FPrintf,
-                  {FileHandle, FormatStr,
-                   ConstantInt::get(Type::getInt32Ty(Ctx), TrueBranchID)});
-            }
-
-            // Insert logging in FalseDest
-            {
-              IRBuilder<> Builder(&*FalseDest->getFirstInsertionPt());
-              // Load FILE* from the global variable
-              Value *FileHandle = Builder.CreateLoad(FilePtrTy, FilePtr);
-              Value *FormatStr = Builder.CreateGlobalStringPtr("br_%d\n");
-              Builder.CreateCall(
-                  FPrintf,
-                  {FileHandle, FormatStr,
-                   ConstantInt::get(Type::getInt32Ty(Ctx), FalseBranchID)});
-            }
-
-            // Get line numbers of the first instructions in the successor
-            // blocks
-            unsigned TrueDestLine = 0, FalseDestLine = 0;
-
-            // Find first instruction with debug info in true branch
-            for (Instruction &Inst : *TrueDest) {
-              if (Inst.getDebugLoc()) {
-                TrueDestLine = Inst.getDebugLoc().getLine();
-                break;
-              }
-            }
-
-            // Find first instruction with debug info in false branch
-            for (Instruction &Inst : *FalseDest) {
-              if (Inst.getDebugLoc()) {
-                FalseDestLine = Inst.getDebugLoc().getLine();
-                break;
-              }
-            }
-
-            // Add branch info to dictionary
-            branchDict.addBranch(TrueBranchID, Filename.str(), SourceLine,
-                                 TrueDestLine);
-            branchDict.addBranch(FalseBranchID, Filename.str(), SourceLine,
-                                 FalseDestLine);
-          }
-        }
-      }
-    }
-  }
-
   // Close the file at the end of main
   if (F.getName() == "main") {
     for (auto &BB : F) {
@@ -155,6 +275,7 @@ PreservedAnalyses FunctionPointerLoggerPass::run(Function &F,
 
   // Preserve logic for writing to branchdictionary.txt
   branchDict.writeToFile("branch-dictionary.txt");
+  branchDict.writePathsToFile("branch-paths.txt");
 
-  return PreservedAnalyses::all();
+  return PreservedAnalyses::none();
 }
\ No newline at end of file
@@ -30,7 +30,9 @@
  */
 
 // IO and datastructure imports
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
 #include <llvm/IR/PassManager.h>
 #include <map>
 #include <queue>
@@ -39,26 +41,68 @@
 #include <vector>
 
 // LLVM imports
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SCCIterator.h"
+#include "llvm/Analysis/CallGraph.h"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/DebugInfo.h"
+#include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/PassPlugin.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
 // standard json libary import
 #include "nlohmann/json.hpp"
 
 #include "llvm/Transforms/Utils/SeminalInputDetector.h"
+#include "llvm/Transforms/Utils/SeminalLibraryCatalog.h"
+#include "llvm/Transforms/Utils/SeminalPointsTo.h"
 
 // using standard llvm namespace
 using namespace llvm;
 
 using Json = nlohmann::json;
 
+static cl::opt<unsigned> ArrayCollapseThreshold(
+    "seminal-array-collapse", cl::init(16),
+    cl::desc("Arrays with more elements than this are tracked as a single "
+             "abstract location by the seminal input detector"));
+
+static cl::opt<bool> ImplicitFlows(
+    "seminal-implicit-flows", cl::init(true),
+    cl::desc("Also report input that reaches a sink only through the "
+             "branches controlling it (implicit flows)"));
+
+static cl::opt<std::string> CostOracle(
+    "seminal-cost-oracle", cl::init(""), cl::value_desc("file"),
+    cl::desc("Write a C function predict_cost() estimating the program's "
+             "cost from its seminal inputs to this file"));
+
+static cl::opt<double> CostScale(
+    "seminal-cost-scale", cl::init(1.0),
+    cl::desc("Nanoseconds per unit of target instruction cost in the "
+             "generated cost oracle"));
+
+/**
+ * The aspect of an input a seminal variable stands for: its value, a number
+ * of iterations it bounds, the length of an input stream or buffer, or the
+ * depth of a recursion it controls. A length lets a cost model take one
+ * scalar per stream instead of its bytes.
+ */
+enum class FeatureKind { Value, Count, Length, Depth };
+
 /**
  * Represents information about a variable, including its name and the line
  * number where it is defined or used. This structure is used to track
@@ -76,12 +120,22 @@ struct VarInfo {
    */
   int line;
 
+  /**
+   * The abstract memory location (object, field or element) holding the
+   * variable. Input taint is attached to locations, so this decides whether
+   * the variable is reported as IO. ~0u means the variable is not in memory.
+   */
+  unsigned location;
+
+  /** What the variable contributes to the program's behavior. */
+  FeatureKind feature;
+
   /**
    * Default constructor for VarInfo. Initializes name as an empty string and
    * line as -1. The default line number of -1 indicates that no valid line
    * has been assigned.
    */
-  VarInfo() : name(""), line(-1) {}
+  VarInfo() : name(""), line(-1), location(~0u), feature(FeatureKind::Value) {}
 
   /**
    * Parameterized constructor for VarInfo. Initializes the variable with the
@@ -89,14 +143,306 @@ struct VarInfo {
    *
    * @param n The name of the variable.
    * @param l The line number where the variable is defined or used.
+   * @param loc The abstract memory location holding the variable, if any.
+   */
+  VarInfo(std::string n, int l, unsigned loc = ~0u)
+      : name(n), line(l), location(loc), feature(FeatureKind::Value) {}
+};
+
+/**
+ * Interned table of abstract memory locations. A location is a memory object
+ * (alloca, global or heap site) or a struct field / array element below
+ * another location, so the table is a trie of access paths: each entry only
+ * stores its parent and the step taken from it. Arrays larger than the
+ * collapse threshold, and elements at unknown indices, share one `[*]` entry.
+ */
+class LocationTable {
+public:
+  /** Returned when a pointer does not resolve to a location. */
+  static constexpr unsigned NoLocation = ~0u;
+
+  /** How a location is reached from its parent. */
+  enum StepKind : uint8_t { Root, Field, Element, AnyElement };
+
+  /** One entry of the trie. */
+  struct Entry {
+    /** The memory object the access path starts from. */
+    const Value *object;
+    /** The parent location, or NoLocation for roots. */
+    unsigned parent;
+    /** The step from the parent to this location. */
+    StepKind kind;
+    /** The field or element index of the step. */
+    unsigned index;
+    /** The IR type stored at this location, if known. */
+    Type *type;
+  };
+
+  /**
+   * Returns the location of a whole memory object.
+   */
+  unsigned getRoot(const Value *object) {
+    auto inserted = roots.try_emplace(object, entries.size());
+    if (inserted.second) {
+      Type *type = nullptr;
+      if (const AllocaInst *alloca = dyn_cast<AllocaInst>(object)) {
+        type = alloca->getAllocatedType();
+      } else if (const GlobalVariable *global =
+                     dyn_cast<GlobalVariable>(object)) {
+        type = global->getValueType();
+      }
+      entries.push_back({object, NoLocation, Root, 0, type});
+    }
+    return inserted.first->second;
+  }
+
+  /**
+   * Returns the location one step below a parent, collapsing array elements
+   * past the threshold into the parent's `[*]` entry. Untyped objects (heap
+   * sites) take their type from the first aggregate indexed into them.
+   */
+  unsigned getChild(unsigned parent, StepKind kind, unsigned index,
+                    Type *indexedType = nullptr) {
+    if (!entries[parent].type && entries[parent].kind == Root) {
+      entries[parent].type = indexedType;
+    }
+    Type *parentType = entries[parent].type;
+    Type *type = parentType;
+    if (kind == Field) {
+      StructType *structType = dyn_cast_or_null<StructType>(parentType);
+      if (!structType || index >= structType->getNumElements()) {
+        return parent;
+      }
+      type = structType->getElementType(index);
+    } else if (ArrayType *arrayType =
+                   dyn_cast_or_null<ArrayType>(parentType)) {
+      type = arrayType->getElementType();
+      if (arrayType->getNumElements() > ArrayCollapseThreshold) {
+        kind = AnyElement;
+      }
+    }
+    if (kind == Element && index >= ArrayCollapseThreshold) {
+      kind = AnyElement;
+    }
+    if (kind == AnyElement) {
+      index = 0;
+    }
+
+    uint64_t key = (uint64_t(parent) << 32) | (uint64_t(kind) << 30) | index;
+    auto inserted = children.try_emplace(key, entries.size());
+    if (inserted.second) {
+      entries.push_back({entries[parent].object, parent, kind, index, type});
+    }
+    return inserted.first->second;
+  }
+
+  /**
+   * Returns a trie entry.
+   */
+  const Entry &get(unsigned location) const { return entries[location]; }
+
+  /**
+   * Marks a location as written by input. Its ancestors and the location
+   * with every element index collapsed are remembered too, so overlapping
+   * accesses can be answered by walking a single parent chain.
+   */
+  void markInput(unsigned location) {
+    input.insert(location);
+    input.insert(getCollapsed(location));
+    for (unsigned parent = entries[location].parent; parent != NoLocation;
+         parent = entries[parent].parent) {
+      inputAncestors.insert(parent);
+    }
+  }
+
+  /**
+   * Returns true if the location overlaps memory written by input: it, an
+   * enclosing location, or a location inside it was marked.
+   */
+  bool overlapsInput(unsigned location) {
+    if (location == NoLocation) {
+      return false;
+    }
+    if (inputAncestors.count(location)) {
+      return true;
+    }
+
+    for (unsigned current : {location, getCollapsed(location)}) {
+      for (; current != NoLocation; current = entries[current].parent) {
+        if (input.count(current)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+private:
+  /**
+   * Returns the location with every element step replaced by `[*]`.
+   */
+  unsigned getCollapsed(unsigned location) {
+    const Entry &entry = entries[location];
+    if (entry.kind == Root) {
+      return location;
+    }
+
+    unsigned parent = getCollapsed(entry.parent);
+    StepKind kind = entry.kind == Field ? Field : AnyElement;
+    return getChild(parent, kind, entry.index);
+  }
+
+  std::vector<Entry> entries;
+  DenseMap<const Value *, unsigned> roots;
+  DenseMap<uint64_t, unsigned> children;
+  std::set<unsigned> input;
+  std::set<unsigned> inputAncestors;
+};
+
+/**
+ * Source-level description of a memory object: a declared local, a global
+ * variable, or a heap allocation site.
+ */
+struct ObjectInfo {
+  /** The source name of the object, e.g. `board` or `*buffer`. */
+  std::string name;
+
+  /** The declaration (or allocation) line, -1 if unknown. */
+  int line;
+
+  /** The debug type of the object, used to name its fields. */
+  DIType *type;
+};
+
+/**
+ * Module-wide state shared by the per-function runs of the pass. It is built
+ * once, the first time a function of the module is analyzed.
+ */
+struct ModuleState {
+  /** The module the state describes. */
+  Module *M;
+
+  /** Unification-based points-to analysis of the whole module. */
+  std::unique_ptr<SeminalPointsTo> PTA;
+
+  /** Abstract memory locations, marked where input writes them. */
+  LocationTable locations;
+
+  /** Descriptions of every named object: locals, globals and heap sites. */
+  DenseMap<const Value *, ObjectInfo> objects;
+
+  /** The recursive strongly connected components of the call graph. */
+  std::vector<std::vector<Function *>> recursiveSCCs;
+
+  /** Index into recursiveSCCs of every recursive function. */
+  DenseMap<const Function *, unsigned> recursiveSCCOf;
+};
+
+/**
+ * Bundles the analyses the def-use engine consults while walking the
+ * definitions of a sink.
+ */
+struct DefUseContext {
+  /** The function being analyzed; only its loads are resolved by MSSA. */
+  Function *F;
+
+  /** The MemorySSA of F. */
+  MemorySSA *MSSA;
+
+  /** The module-wide points-to analysis, locations and object table. */
+  ModuleState *module;
+};
+
+/**
+ * A dynamic decision point: an instruction whose operand decides which code
+ * runs, or how often.
+ */
+struct Sink {
+  enum Kind {
+    LoopExit,
+    Switch,
+    Select,
+    IndirectCall,
+    Allocation,
+    RecursionExit
+  };
+
+  /** What kind of decision the sink makes. */
+  Kind kind;
+
+  /**
+   * The branch, switch, select, call or allocation making the decision; for
+   * a RecursionExit, the terminator deciding whether a recursive call runs.
    */
-  VarInfo(std::string n, int l) : name(n), line(l) {}
+  Instruction *inst;
+
+  /**
+   * The deciding operand: a condition, a called function pointer, or a
+   * factor of an allocation's size.
+   */
+  Value *operand;
+
+  /** The loop a LoopExit leaves; null for other kinds. */
+  Loop *loop;
 };
 
+/**
+ * A product of seminal features (`n`, `len(fp)`); a call to a function
+ * defined in the module appears as `@name` until it is resolved to the
+ * callee's own complexity.
+ */
+using Monomial = std::multiset<std::string>;
+
+/**
+ * A sum of monomials with no dominated terms: `n*m + k`. The empty monomial
+ * is a constant.
+ */
+using Complexity = std::set<Monomial>;
+
+/** The unresolved complexity of each function analyzed, by name. */
+std::map<std::string, Complexity> complexitySummaries;
+
+/**
+ * The estimated cost of a function: for each product of trip counts (a C
+ * expression over the seminal inputs, empty for one) and callee (empty for
+ * none), the target cost of the instructions executed that many times.
+ */
+using CostSummary = std::map<std::pair<std::string, std::string>, double>;
+
+/** The cost of each function analyzed, by name. */
+std::map<std::string, CostSummary> costSummaries;
+
+/**
+ * The features held in `struct seminal_inputs`, with their fields. Features
+ * whose identifiers coincide (`len(fp)` and `len_fp`) get distinct fields.
+ */
+std::map<std::string, std::string> costFields;
+
+/** The field names taken in `struct seminal_inputs`. */
+std::set<std::string> costFieldNames;
+
 nlohmann::json importantVar;
 
+/**
+ * Whether the detector ran in this process. The writer below is linked into
+ * every `opt`, and must not replace the detector's output when only other
+ * passes ran.
+ */
+bool detectorRan = false;
+
+void finalizeComplexity();
+void writeCostOracle();
+
 struct JsonFileWriter {
   ~JsonFileWriter() {
+    if (!detectorRan) {
+      return;
+    }
+    if (importantVar.is_null()) {
+      importantVar = nlohmann::json::array();
+    }
+    finalizeComplexity();
+    writeCostOracle();
     std::ofstream file("seminal-values.json");
     file << importantVar.dump(4);
     file.close();
@@ -104,159 +450,446 @@ struct JsonFileWriter {
 } jsonFileWriter;
 
 // Declare the function prototype at the beginning
-DbgDeclareInst *getDbg(Value *targetValue, Function *F);
-
 void getDefUseChain(Value *value, std::set<Value *> *visited,
                     std::unordered_map<std::string, VarInfo> *variableMap,
-                    Function *F);
+                    DefUseContext *ctx);
 
 // ---- HELPER FUNCTIONS ----
 
 /**
- * Handles allocations (AllocaInst), adding relevant variable information to the
- * map.
+ * Resolves a pointer to the abstract locations it may address. Constant GEP
+ * indices become field and element steps below the base object; a base that
+ * is not itself an object (a parameter, a loaded pointer) stands for every
+ * object of its points-to class.
  *
- * @param instruction The instruction that might be an allocation.
- * @param function The function in which the allocation occurs.
- * @param VarInfoMap A map to store variables and their information.
+ * @param pointer The address to resolve.
+ * @param PTA The module-wide points-to analysis.
+ * @param locations The table of abstract locations.
+ * @return The locations the pointer may address.
  */
-void handleAllocations(Instruction *instruction, Function *function,
-                       std::unordered_map<std::string, VarInfo> *VarInfoMap) {
-    // CHECK: Ensure that the required pointers are not null
-  if (!instruction) {
-    llvm::errs() << "Error: Null instruction passed to handleAllocations.\n";
-    return;  // Exit early if the instruction is null
+std::vector<unsigned> resolveLocations(Value *pointer, SeminalPointsTo *PTA,
+                                       LocationTable *locations) {
+  // Peel the GEPs and casts off the pointer, innermost GEP last
+  std::vector<GEPOperator *> geps;
+  Value *base = pointer;
+  while (true) {
+    if (GEPOperator *gep = dyn_cast<GEPOperator>(base)) {
+      geps.push_back(gep);
+      base = gep->getPointerOperand();
+    } else if (isa<BitCastOperator>(base) || isa<AddrSpaceCastOperator>(base)) {
+      base = cast<Operator>(base)->getOperand(0);
+    } else {
+      break;
+    }
   }
 
-  if (!function) {
-    llvm::errs() << "Error: Null function passed to handleAllocations.\n";
-    return;  // Exit early if function is null
-  }
+  // Translate the GEP indices into access-path steps, outermost first
+  struct Step {
+    LocationTable::StepKind kind;
+    unsigned index;
+    Type *indexedType;
+  };
+  std::vector<Step> steps;
+  for (auto it = geps.rbegin(); it != geps.rend(); ++it) {
+    GEPOperator *gep = *it;
+    Type *type = gep->getSourceElementType();
+    for (unsigned i = 1; i < gep->getNumOperands(); ++i) {
+      ConstantInt *constant = dyn_cast<ConstantInt>(gep->getOperand(i));
+      unsigned index = constant ? constant->getLimitedValue(~0u) : 0;
+      LocationTable::StepKind kind =
+          constant ? LocationTable::Element : LocationTable::AnyElement;
+
+      // The first index is pointer arithmetic over the pointed-to memory
+      if (i == 1) {
+        if (!constant || !constant->isZero()) {
+          steps.push_back({kind, index, nullptr});
+        }
+        continue;
+      }
 
-  if (!VarInfoMap) {
-    llvm::errs() << "Error: Null VarInfoMap passed to handleAllocations.\n";
-    return;  // Exit early if VarInfoMap is null
+      if (StructType *structType = dyn_cast<StructType>(type)) {
+        steps.push_back({LocationTable::Field, index, type});
+        type = structType->getElementType(index);
+      } else {
+        steps.push_back({kind, index, type});
+        if (ArrayType *arrayType = dyn_cast<ArrayType>(type)) {
+          type = arrayType->getElementType();
+        } else if (VectorType *vectorType = dyn_cast<VectorType>(type)) {
+          type = vectorType->getElementType();
+        }
+      }
+    }
   }
 
-  // Exit early if the instruction is not an AllocaInst
-  AllocaInst *allocaInst = dyn_cast<AllocaInst>(instruction);
-  if (!allocaInst)
-    return;
-
-  // Exit early if no dbgDeclare or variable is found
-  DbgDeclareInst *dbgDeclare = getDbg(allocaInst, function);
-  if (!dbgDeclare || !dbgDeclare->getVariable())
-    return;
+  std::vector<unsigned> roots;
+  if (isa<AllocaInst>(base) || isa<GlobalVariable>(base) ||
+      SeminalPointsTo::isHeapAllocation(base)) {
+    roots.push_back(locations->getRoot(base));
+  } else {
+    for (const Value *object : PTA->getObjects(PTA->getMemoryClass(base))) {
+      roots.push_back(locations->getRoot(object));
+    }
+  }
 
-  std::string varName = dbgDeclare->getVariable()->getName().str();
-  int lineNo = dbgDeclare->getDebugLoc().getLine();
-  // Track the variable allocation in the map
-  (*VarInfoMap)[varName] = VarInfo(varName, lineNo);
+  std::vector<unsigned> resolved;
+  for (unsigned location : roots) {
+    for (Step &step : steps) {
+      location = locations->getChild(location, step.kind, step.index,
+                                     step.indexedType);
+    }
+    resolved.push_back(location);
+  }
+  return resolved;
 }
 
 /**
- * Handles stores (StoreInst), tracking the definition-use chain for stored
- * values and locations.
+ * Strips typedefs and cv-qualifiers off a debug type.
  *
- * @param instruction The instruction that might be a store.
- * @param seenValues A set of visited values to avoid re-processing.
- * @param VarInfoMap A map to store variables and their information.
- * @param function The function in which the store occurs.
+ * @param type The debug type to strip.
+ * @return The underlying debug type.
  */
-void handleStores(Instruction *instruction, std::set<Value *> *seenValues,
-                  std::unordered_map<std::string, VarInfo> *VarInfoMap,
-                  Function *function) {
+DIType *llvm::stripDebugQualifiers(DIType *type) {
+  while (DIDerivedType *derived = dyn_cast_or_null<DIDerivedType>(type)) {
+    unsigned tag = derived->getTag();
+    if (tag != dwarf::DW_TAG_typedef && tag != dwarf::DW_TAG_const_type &&
+        tag != dwarf::DW_TAG_volatile_type &&
+        tag != dwarf::DW_TAG_restrict_type &&
+        tag != dwarf::DW_TAG_atomic_type) {
+      break;
+    }
+    type = derived->getBaseType();
+  }
+  return type;
+}
 
-    // CHECK: Ensure that the required pointers are not null
-  if (!instruction) {
-    llvm::errs() << "Error: Null instruction passed to handleStores.\n";
-    return;  // Exit early if the instruction is null
+/**
+ * Builds the source-level name of a location, e.g. `game.guesses_size` or
+ * `mat[*][3]`, using the debug types to name struct fields.
+ *
+ * @param location The location to name.
+ * @param state The module state holding the locations and object table.
+ * @param name Receives the name of the location.
+ * @param line Receives the declaration line of the enclosing variable.
+ * @return True if the location belongs to a named object.
+ */
+bool describeLocation(unsigned location, ModuleState *state,
+                      std::string *name, int *line) {
+  LocationTable *locations = &state->locations;
+  std::vector<unsigned> path;
+  for (unsigned current = location; current != LocationTable::NoLocation;
+       current = locations->get(current).parent) {
+    path.push_back(current);
   }
 
-  if (!seenValues) {
-    llvm::errs() << "Error: Null seenValues passed to handleStores.\n";
-    return;  // Exit early if seenValues is null
+  auto object = state->objects.find(locations->get(location).object);
+  if (object == state->objects.end()) {
+    return false;
   }
 
-  if (!VarInfoMap) {
-    llvm::errs() << "Error: Null VarInfoMap passed to handleStores.\n";
-    return;  // Exit early if VarInfoMap is null
+  *name = object->second.name;
+  *line = object->second.line;
+
+  // Walk from the object down, following the debug type alongside
+  const DataLayout &DL = state->M->getDataLayout();
+  DIType *debugType = object->second.type;
+  unsigned dimensions = 0;
+  for (auto it = path.rbegin() + 1; it != path.rend(); ++it) {
+    const LocationTable::Entry &entry = locations->get(*it);
+    const LocationTable::Entry &parent = locations->get(entry.parent);
+    DICompositeType *composite =
+        dyn_cast_or_null<DICompositeType>(stripDebugQualifiers(debugType));
+
+    if (entry.kind == LocationTable::Field) {
+      // Match the IR field to its debug member through the field offset
+      StructType *structType = dyn_cast_or_null<StructType>(parent.type);
+      DIDerivedType *member = nullptr;
+      if (composite && structType) {
+        uint64_t offset = DL.getStructLayout(structType)
+                              ->getElementOffsetInBits(entry.index);
+        for (DINode *element : composite->getElements()) {
+          DIDerivedType *candidate = dyn_cast<DIDerivedType>(element);
+          if (candidate && candidate->getTag() == dwarf::DW_TAG_member &&
+              candidate->getOffsetInBits() == offset) {
+            member = candidate;
+            break;
+          }
+        }
+      }
+
+      if (member) {
+        *name += "." + member->getName().str();
+        debugType = member->getBaseType();
+      } else {
+        *name += ".field" + std::to_string(entry.index);
+        debugType = nullptr;
+      }
+      dimensions = 0;
+      continue;
+    }
+
+    *name += entry.kind == LocationTable::AnyElement
+                 ? std::string("[*]")
+                 : "[" + std::to_string(entry.index) + "]";
+
+    // A multi-dimensional debug array carries one subrange per dimension
+    if (composite && composite->getTag() == dwarf::DW_TAG_array_type &&
+        ++dimensions >= composite->getElements().size()) {
+      debugType = composite->getBaseType();
+      dimensions = 0;
+    }
   }
+  return true;
+}
 
-  if (!function) {
-    llvm::errs() << "Error: Null Function passed to handleStores.\n";
-    return;  // Exit early if function is null
+/**
+ * Records the named variables a pointer addresses, down to the struct field
+ * or array element. Pointers that are not a declared variable themselves
+ * (parameters, loaded pointers) name the objects of their points-to class.
+ *
+ * @param pointer The address being loaded from.
+ * @param variableMap A map to store variables and their information.
+ * @param ctx The analyses of the function being analyzed.
+ */
+void recordVariable(Value *pointer,
+                    std::unordered_map<std::string, VarInfo> *variableMap,
+                    DefUseContext *ctx) {
+  ModuleState *state = ctx->module;
+  for (unsigned location :
+       resolveLocations(pointer, state->PTA.get(), &state->locations)) {
+    std::string varName;
+    int lineNo = -1;
+    if (describeLocation(location, state, &varName, &lineNo)) {
+      (*variableMap)[varName] = VarInfo(varName, lineNo, location);
+    }
   }
+}
 
-  // Exit early if the instruction is not a StoreInst
-  StoreInst *storeInst = dyn_cast<StoreInst>(instruction);
-  if (!storeInst)
-    return;
+/**
+ * Returns true if an instruction is a catalogued library call that writes no
+ * memory (e.g. `getchar`, `strlen`); it cannot be what a read observes.
+ *
+ * @param inst A may-writer reported by MemorySSA or the points-to analysis.
+ */
+bool isReadOnlyLibraryCall(Instruction *inst) {
+  const SeminalLibraryModel *model =
+      SeminalLibraryCatalog::get().lookup(dyn_cast<CallBase>(inst));
+  return model && !model->writesMemory();
+}
+
+/**
+ * Walks the memory dependences of a read upwards through MemorySSA, following
+ * only the definitions that may have written the read location.
+ *
+ * A store that writes exactly the read pointer kills the walk; stores and
+ * calls that only may alias are followed and the walk continues past them.
+ * Reaching liveOnEntry ends the walk, as the memory was written outside F.
+ *
+ * @param access The clobbering access to start from.
+ * @param loc The memory being read (a load, or memory a library call reads).
+ * @param visited A set of visited values. Memory accesses are tracked apart,
+ * per location, as the clobbers found above an access depend on what is read.
+ * @param variableMap A map to store variables and their information.
+ * @param ctx The analyses of the function the load resides in.
+ */
+void followMemoryDefs(MemoryAccess *access, const MemoryLocation &loc,
+                      std::set<Value *> *visited,
+                      std::unordered_map<std::string, VarInfo> *variableMap,
+                      DefUseContext *ctx) {
+  MemorySSA *MSSA = ctx->MSSA;
+  MemorySSAWalker *walker = MSSA->getWalker();
+
+  // Worklist of clobbering accesses still to be explained
+  std::vector<MemoryAccess *> worklist = {access};
+  DenseSet<std::pair<MemoryAccess *, MemoryLocation>> explained;
+  while (!worklist.empty()) {
+    MemoryAccess *current = worklist.back();
+    worklist.pop_back();
+
+    // CHECK: memory from outside the function, or already explained for loc
+    if (!current || MSSA->isLiveOnEntryDef(current) ||
+        !explained.insert({current, loc}).second) {
+      continue;
+    }
+
+    // A phi merges the definitions reaching along each incoming edge
+    if (MemoryPhi *phi = dyn_cast<MemoryPhi>(current)) {
+      for (unsigned i = 0; i < phi->getNumIncomingValues(); ++i) {
+        worklist.push_back(
+            walker->getClobberingMemoryAccess(phi->getIncomingValue(i), loc));
+      }
+      continue;
+    }
+
+    MemoryDef *def = dyn_cast<MemoryDef>(current);
+    if (!def || !def->getMemoryInst()) {
+      continue;
+    }
+
+    Instruction *defInst = def->getMemoryInst();
+    if (StoreInst *store = dyn_cast<StoreInst>(defInst)) {
+      // The stored value is what the load observes
+      getDefUseChain(store->getValueOperand(), visited, variableMap, ctx);
 
-  Value *storedValue = storeInst->getValueOperand();
-  Value *storedLocation = storeInst->getPointerOperand();
-  // Track the def-use chains for stored values and locations
-  getDefUseChain(storedValue, seenValues, VarInfoMap, function);
-  getDefUseChain(storedLocation, seenValues, VarInfoMap, function);
+      // A store to the very same pointer fully overwrites the location
+      if (store->getPointerOperand()->stripPointerCasts() ==
+          loc.Ptr->stripPointerCasts()) {
+        continue;
+      }
+    } else if (!isReadOnlyLibraryCall(defInst)) {
+      // Calls (e.g. scanf) and other writers are tracked like any instruction
+      getDefUseChain(defInst, visited, variableMap, ctx);
+    }
+
+    // The def only may have written the location, keep walking upwards
+    worklist.push_back(
+        walker->getClobberingMemoryAccess(def->getDefiningAccess(), loc));
+  }
 }
 
 /**
- * Finds the DbgDeclareInst for a given value in a function.
+ * Follows the writers of a read's memory class that MemorySSA cannot see:
+ * those in other functions, or every writer when the read itself lies outside
+ * the analyzed function. This carries taint through pointers, globals and
+ * heap objects across the module.
  *
- * @param targetValue The value whose DbgDeclareInst we are searching for.
- * @param function The function in which the DbgDeclareInst might be found.
- * @return A pointer to the DbgDeclareInst if found, or nullptr if not found.
+ * @param pointer The address being read.
+ * @param reader The load or call reading the memory.
+ * @param visited A set of visited values.
+ * @param variableMap A map to store variables and their information.
+ * @param ctx The analyses of the function being analyzed.
  */
-DbgDeclareInst *getDbg(Value *targetValue, Function *F) {
+void followMemoryWriters(Value *pointer, Instruction *reader,
+                         std::set<Value *> *visited,
+                         std::unordered_map<std::string, VarInfo> *variableMap,
+                         DefUseContext *ctx) {
+  bool local = reader->getFunction() == ctx->F;
+  SeminalPointsTo *PTA = ctx->module->PTA.get();
+  unsigned memoryClass = PTA->getMemoryClass(pointer);
+  for (Instruction *writer : PTA->getWriters(memoryClass)) {
+    // Writers in the analyzed function were already resolved by MemorySSA,
+    // except calls filling the memory they return (strdup's copy), which
+    // MemorySSA sees as creating it rather than writing it
+    const SeminalLibraryModel *model =
+        SeminalLibraryCatalog::get().lookup(dyn_cast<CallBase>(writer));
+    if (local && writer->getFunction() == ctx->F &&
+        !(model && model->writesReturnedMemory())) {
+      continue;
+    }
 
-  // CHECK: Ensure that the required pointers are not null
-  if (!targetValue) {
-    llvm::errs() << "Error: Null targetValue passed to getDbg.\n";
-    return nullptr;  // Return nullptr to indicate failure
+    if (StoreInst *store = dyn_cast<StoreInst>(writer)) {
+      getDefUseChain(store->getValueOperand(), visited, variableMap, ctx);
+    } else if (!isReadOnlyLibraryCall(writer)) {
+      getDefUseChain(writer, visited, variableMap, ctx);
+    }
   }
+}
 
-  if (!F) {
-    llvm::errs() << "Error: Null Function passed to getDbg.\n";
-    return nullptr;  // Return nullptr to indicate failure
+/**
+ * Returns the array a decayed pointer (`&buf[0]`) was taken from. Library
+ * calls handed such a pointer read or write the whole array, not its first
+ * element.
+ *
+ * @param pointer A pointer argument of a library call.
+ * @return The array, or the pointer itself if it is not a decayed array.
+ */
+Value *stripArrayDecay(Value *pointer) {
+  GEPOperator *gep = dyn_cast<GEPOperator>(pointer);
+  while (gep && gep->hasAllZeroIndices() &&
+         isa<ArrayType>(gep->getSourceElementType())) {
+    pointer = gep->getPointerOperand();
+    gep = dyn_cast<GEPOperator>(pointer);
   }
+  return pointer;
+}
 
-  // Iterate over each BasicBlock in the Function
-  for (auto blockIt = F->begin(); blockIt != F->end(); ++blockIt) {
-    BasicBlock &basicBlock = *blockIt;
+/**
+ * Follows the memory a library call reads through a pointer argument, the
+ * way a load of that memory would be followed.
+ *
+ * @param pointer The pointer argument whose memory is read.
+ * @param call The library call reading it.
+ * @param visited A set of visited values.
+ * @param variableMap A map to store variables and their information.
+ * @param ctx The analyses of the function being analyzed.
+ */
+void followPointee(Value *pointer, CallBase *call, std::set<Value *> *visited,
+                   std::unordered_map<std::string, VarInfo> *variableMap,
+                   DefUseContext *ctx) {
+  if (!pointer->getType()->isPointerTy()) {
+    return;
+  }
 
-    // Iterate over each Instruction in the BasicBlock
-    for (auto instIt = basicBlock.begin(); instIt != basicBlock.end();
-         ++instIt) {
-      Instruction &instruction = *instIt;
+  recordVariable(stripArrayDecay(pointer), variableMap, ctx);
+  getDefUseChain(pointer, visited, variableMap, ctx);
 
-      // Check if the Instruction is a DbgDeclareInst
-      if (DbgDeclareInst *dbgDeclareInst =
-              dyn_cast<DbgDeclareInst>(&instruction)) {
-        // Check if the address of the DbgDeclareInst matches the given
-        // targetValue
-        if (dbgDeclareInst->getAddress() == targetValue) {
-          return dbgDeclareInst;
-        }
-      }
+  if (call->getFunction() == ctx->F) {
+    MemoryUseOrDef *access = ctx->MSSA->getMemoryAccess(call);
+    if (access) {
+      MemoryLocation loc = MemoryLocation::getBeforeOrAfter(pointer);
+      MemoryAccess *clobber = ctx->MSSA->getWalker()->getClobberingMemoryAccess(
+          access->getDefiningAccess(), loc);
+      followMemoryDefs(clobber, loc, visited, variableMap, ctx);
+    }
+  }
+  followMemoryWriters(pointer, call, visited, variableMap, ctx);
+}
+
+/**
+ * Applies the catalog model of a library call: only the endpoints data flows
+ * from are followed, instead of every argument. The call may be reached as
+ * the definition of its result or as a writer of memory; both are covered
+ * by following every flow of the model. The result of an input source is
+ * itself recorded, as in SSA form it never passes through memory.
+ *
+ * @param call The library call reached by the walk.
+ * @param model The catalog model of the callee.
+ * @param visited A set of visited values.
+ * @param variableMap A map to store variables and their information.
+ * @param ctx The analyses of the function being analyzed.
+ */
+void followLibraryCall(CallBase *call, const SeminalLibraryModel *model,
+                       std::set<Value *> *visited,
+                       std::unordered_map<std::string, VarInfo> *variableMap,
+                       DefUseContext *ctx) {
+  // An input result held in a register is named through its dbg.value
+  if (model->isSource()) {
+    ModuleState *state = ctx->module;
+    unsigned location = state->locations.getRoot(call);
+    std::string varName;
+    int lineNo = -1;
+    if (describeLocation(location, state, &varName, &lineNo)) {
+      (*variableMap)[varName] = VarInfo(varName, lineNo, location);
     }
   }
 
-  return nullptr; // Return null if no matching DbgDeclareInst is found
+  for (const SeminalFlow &flow : model->flows) {
+    for (Value *argument : flow.from.getArguments(call)) {
+      if (flow.from.isMemory()) {
+        followPointee(argument, call, visited, variableMap, ctx);
+      } else {
+        getDefUseChain(argument, visited, variableMap, ctx);
+      }
+    }
+  }
 }
 
 /**
  * Recursively finds the definition-use chain of a given value, recording
  * important variables.
  *
+ * Loads in the analyzed function are resolved precisely through MemorySSA;
+ * memory shared with other functions is resolved through the points-to
+ * classes, and parameters and call results are followed across calls.
+ *
  * @param value The value to start tracking from.
  * @param visited A set of visited values to avoid processing the same value
  * multiple times.
  * @param variableMap A map to store variables and their information.
- * @param F The function in which the value resides.
+ * @param ctx The analyses of the function being analyzed.
  */
 void getDefUseChain(Value *value, std::set<Value *> *visited,
                     std::unordered_map<std::string, VarInfo> *variableMap,
-                    Function *F) {
+                    DefUseContext *ctx) {
 
       // CHECK: Ensure that the required pointers are not null
   if (!value) {
@@ -274,8 +907,8 @@ void getDefUseChain(Value *value, std::set<Value *> *visited,
     return;
   }
 
-  if (!F) {
-    llvm::errs() << "Error: Null function passed to getDefUseChain.\n";
+  if (!ctx || !ctx->F || !ctx->MSSA || !ctx->module) {
+    llvm::errs() << "Error: Null analysis context passed to getDefUseChain.\n";
     return;
   }
 
@@ -285,6 +918,18 @@ void getDefUseChain(Value *value, std::set<Value *> *visited,
     return;
   }
 
+  // A parameter is defined by the actual arguments at every call site
+  if (Argument *arg = dyn_cast<Argument>(value)) {
+    for (User *user : arg->getParent()->users()) {
+      CallBase *call = dyn_cast<CallBase>(user);
+      if (call && call->getCalledFunction() == arg->getParent()) {
+        getDefUseChain(call->getArgOperand(arg->getArgNo()), visited,
+                       variableMap, ctx);
+      }
+    }
+    return;
+  }
+
   // If the value is an instruction, process it
   if (Instruction *inst = dyn_cast<Instruction>(value)) {
 
@@ -293,19 +938,20 @@ void getDefUseChain(Value *value, std::set<Value *> *visited,
       Value *loadedValue =
           LoadInstVar->getPointerOperand(); // Get the pointer being loaded from
 
-      // Find the DbgDeclareInst for the loaded value
-      DbgDeclareInst *DbgDeclare = getDbg(loadedValue, F);
-      if (DbgDeclare && DbgDeclare->getVariable()) {
-        // If we find a DbgDeclare, record the variable's name and location in
-        // the variable map
-        std::string varName = DbgDeclare->getVariable()->getName().str();
-        int lineNo = DbgDeclare->getDebugLoc().getLine();
-        (*variableMap)[varName] =
-            VarInfo(varName, lineNo); // Add the variable info to the map
-      }
+      // Record the variable (or pointed-to variables) being read
+      recordVariable(loadedValue, variableMap, ctx);
 
-      // Recursively track the loaded value (i.e., follow the def-use chain)
-      getDefUseChain(loadedValue, visited, variableMap, F);
+      // Recursively track the address computation (e.g. GEP indices)
+      getDefUseChain(loadedValue, visited, variableMap, ctx);
+
+      // Follow only the defs that may have written the loaded memory
+      if (inst->getFunction() == ctx->F) {
+        MemoryAccess *clobber =
+            ctx->MSSA->getWalker()->getClobberingMemoryAccess(LoadInstVar);
+        followMemoryDefs(clobber, MemoryLocation::get(LoadInstVar), visited,
+                         variableMap, ctx);
+      }
+      followMemoryWriters(loadedValue, LoadInstVar, visited, variableMap, ctx);
 
       // If the instruction is a StoreInst (i.e., storing a value into memory)
     } else if (StoreInst *StoreInstVar = dyn_cast<StoreInst>(inst)) {
@@ -317,23 +963,37 @@ void getDefUseChain(Value *value, std::set<Value *> *visited,
 
       // Recursively track both the stored value and the location (i.e., follow
       // the def-use chain)
-      getDefUseChain(storedValue, visited, variableMap, F);
-      getDefUseChain(storedLocation, visited, variableMap, F);
+      getDefUseChain(storedValue, visited, variableMap, ctx);
+      getDefUseChain(storedLocation, visited, variableMap, ctx);
 
       // If the instruction is a CallInst (i.e., a function call)
     } else if (CallInst *CI = dyn_cast<CallInst>(inst)) {
 
-      // If the call has a return value, track it recursively (ignoring
-      // void-returning calls)
-      if (CI->getType() != Type::getVoidTy(F->getContext())) {
-        getDefUseChain(CI, visited, variableMap, F);
+      // Library calls with a catalog model move data only along its flows
+      if (const SeminalLibraryModel *model =
+              SeminalLibraryCatalog::get().lookup(CI)) {
+        followLibraryCall(CI, model, visited, variableMap, ctx);
+        return;
       }
 
       // Track all the arguments passed to the function call
       for (auto arg = CI->arg_begin(); arg != CI->arg_end(); ++arg) {
         Value *argValue = *arg;
         getDefUseChain(argValue, visited, variableMap,
-                       F); // Recursively track each argument
+                       ctx); // Recursively track each argument
+      }
+
+      // The result of a defined callee comes from its return statements
+      Function *callee = CI->getCalledFunction();
+      if (callee && !callee->isDeclaration()) {
+        for (Instruction &calleeInst : instructions(*callee)) {
+          if (ReturnInst *ret = dyn_cast<ReturnInst>(&calleeInst)) {
+            if (ret->getReturnValue()) {
+              getDefUseChain(ret->getReturnValue(), visited, variableMap,
+                             ctx);
+            }
+          }
+        }
       }
 
       // If the instruction is of some other type (e.g., binary operation,
@@ -341,7 +1001,7 @@ void getDefUseChain(Value *value, std::set<Value *> *visited,
     } else {
       // Recursively track all operands of the instruction
       for (unsigned i = 0; i < inst->getNumOperands(); ++i) {
-        getDefUseChain(inst->getOperand(i), visited, variableMap, F);
+        getDefUseChain(inst->getOperand(i), visited, variableMap, ctx);
       }
     }
   }
@@ -351,15 +1011,34 @@ void getDefUseChain(Value *value, std::set<Value *> *visited,
 
 // ---- IO FUNCTIONS ----
 
+/**
+ * Returns the name a feature kind is reported under.
+ *
+ * @param feature The feature kind.
+ */
+const char *getFeatureName(FeatureKind feature) {
+  switch (feature) {
+  case FeatureKind::Count:
+    return "count";
+  case FeatureKind::Length:
+    return "length";
+  case FeatureKind::Depth:
+    return "recursion_depth";
+  case FeatureKind::Value:
+    break;
+  }
+  return "value";
+}
+
 /**
  * Creates a JSON object representing the influential variables in the function.
  *
  * @param variableMap A map of variable names to their information.
- * @param ioVar A set of IO variables that have been identified.
+ * @param locations The table of locations, marked where input writes them.
  * @return A JSON array representing the influential variables.
  */
 Json createVariablesJson(const std::unordered_map<std::string, VarInfo> *varMap,
-                         const std::unordered_set<std::string> *ioVar) {
+                         LocationTable *locations) {
 
     // CHECK: Ensure that the required pointers are not null
   if (!varMap) {
@@ -367,31 +1046,29 @@ Json createVariablesJson(const std::unordered_map<std::string, VarInfo> *varMap,
     return Json::array();  // Return an empty array to indicate failure
   }
 
-  if (!ioVar) {
-    llvm::errs() << "Error: Null ioVar passed to createVariablesJson.\n";
+  if (!locations) {
+    llvm::errs() << "Error: Null locations passed to createVariablesJson.\n";
     return Json::array();  // Return an empty array to indicate failure
   }
                           
   // Iterate through all variables to find IO and potential influential
   // variables
-  bool found = false;
   Json variablesJson = Json::array();
   for (auto it = varMap->begin(); it != varMap->end(); ++it) {
     const VarInfo &info =
         it->second; // Access the value (VarInfo) using the iterator
     Json jvar;
 
-    if (ioVar->count(info.name) > 0) {
-      jvar["type"] = "IO";
-      jvar["name"] = info.name;
-      jvar["line"] = info.line;
-      found = true;
-    } 
-    // else {
-    //   jvar["type"] = "Possible";
-    //   jvar["name"] = info.name;
-    //   jvar["line"] = info.line;
-    // }
+    // Only variables reached from a sink that are also input count
+    // (non-IO variables would be reported as "Possible")
+    if (!locations->overlapsInput(info.location)) {
+      continue;
+    }
+
+    jvar["type"] = "IO";
+    jvar["name"] = info.name;
+    jvar["line"] = info.line;
+    jvar["feature"] = getFeatureName(info.feature);
 
     variablesJson.push_back(jvar); // Add the variable to the JSON
   }
@@ -399,186 +1076,1526 @@ Json createVariablesJson(const std::unordered_map<std::string, VarInfo> *varMap,
   return variablesJson;
 }
 
-// ---- END IO FUNCTIONS ----
-
-// ----  Core Functions ----
-
 /**
- * Processes the loops in the given LoopInfo object, tracking variables involved
- * in the loop.
+ * Returns the term a feature appears as in a complexity: the variable's name,
+ * or `len(name)` for a length.
  *
- * @param LI The LoopInfo containing the loops to process.
- * @param seen A set of values that have already been visited.
- * @param vMap A map to store variables and their information.
- * @param F The function in which the loops reside.
- */
-void processLoops(LoopInfo *LI, std::set<Value *> *seen,
-                  std::unordered_map<std::string, VarInfo> *vMap, Function *F) {
-  // Iterate over each loop in LoopInfo
-  for (auto it = LI->begin(); it != LI->end(); ++it) {
-    Loop *loop = *it;
-
-    // Get the loop's header basic block
-    BasicBlock *header = loop->getHeader();
-
-    // Iterate over each Instruction in the header block
-    for (auto I = header->begin(); I != header->end(); ++I) {
-
-      // Check: Is this a conditional branch (Branch Instruction)?
-      if (auto *BI = dyn_cast<BranchInst>(&*I)) {
-        if (BI->isConditional()) {
-          // If it's a conditional branch, analyze its condition
-          Value *condition = BI->getCondition(); // Get the condition operand
-
-          // Check: Is this condition an Instruction?
-          if (Instruction *inst = dyn_cast<Instruction>(condition)) {
-            // Iterate over all operands of the instruction
-            for (unsigned i = 0; i < inst->getNumOperands(); ++i) {
-              // Track the definition-use chain for each operand
-              getDefUseChain(inst->getOperand(i), seen, vMap, F);
-            }
-          }
-        }
-      }
-    }
+ * @param info The feature variable.
+ */
+std::string getFeatureTerm(const VarInfo &info) {
+  if (info.feature == FeatureKind::Length) {
+    return "len(" + info.name + ")";
   }
+  return info.name;
 }
 
 /**
- * Analyzes input-related functions in the provided function.
+ * Returns the factor of a set of features bounding the same loop or
+ * recursion: whichever is reached first ends it, so the factor is their
+ * minimum.
  *
- * @param function The function in which input-related functions are to be
- * analyzed.
- * @param VarInfoMap A map to store variable information encountered during
- * analysis.
+ * @param terms The feature terms.
  */
-void analyzeInputFunctions(Function *function,
-                           std::unordered_map<std::string, VarInfo> *VarInfoMap,
-                           std::unordered_set<std::string> *ioVar) {
-  // Search for input-related variables.
-  for (auto blockIt = function->begin(); blockIt != function->end();
-       ++blockIt) {
-    BasicBlock &basicBlock = *blockIt;
-
-    // Iterate over each instruction in the basic block
-    for (auto instIt = basicBlock.begin(); instIt != basicBlock.end();
-         ++instIt) {
-      Instruction &instruction = *instIt;
-
-      // CHECK: is this is a call instruction
-      if (CallInst *instPointer = dyn_cast<CallInst>(&instruction)) {
-        Function *funPointer = instPointer->getCalledFunction();
-        if (!funPointer) {
-          continue; // Skip if no called function
-        }
-
-        std::string funcName = funPointer->getName().str();
-
-        // Simulating a "switch" using a map or series of if-else for function
-        // names
-        if (funcName.find("scanf") != std::string::npos) {
-          // Handle "scanf" like input function
-          for (unsigned argIdx = 0; argIdx < instPointer->arg_size();
-               ++argIdx) {
-            Value *argValue = instPointer->getArgOperand(argIdx);
-            DbgDeclareInst *dbgDeclare = getDbg(argValue, function);
-            if (dbgDeclare && dbgDeclare->getVariable()) {
-              std::string varName = dbgDeclare->getVariable()->getName().str();
-              int lineNo = dbgDeclare->getDebugLoc().getLine();
-
-              (*VarInfoMap)[varName] = VarInfo(varName, lineNo);
-              ioVar->insert(varName);
-            }
-          }
-        } else if (funcName.find("fopen") != std::string::npos) {
-          // Handle "fopen" like input function
-          for (auto iter = instPointer->getIterator(); iter != basicBlock.end();
-               ++iter) {
-            if (StoreInst *storeInst = dyn_cast<StoreInst>(&*iter)) {
-              if (storeInst->getValueOperand() == instPointer) {
-                Value *storedLocation = storeInst->getPointerOperand();
-                DbgDeclareInst *dbgDeclare = getDbg(storedLocation, function);
-
-                if (dbgDeclare && dbgDeclare->getVariable()) {
-                  std::string varName =
-                      dbgDeclare->getVariable()->getName().str();
-                  int lineNo = dbgDeclare->getDebugLoc().getLine();
-
-                  (*VarInfoMap)[varName] = VarInfo(varName, lineNo);
-                  ioVar->insert(varName);
-                  break; // Stop after finding the first I/O variable related to
-                         // fopen
-                }
-              }
-            }
-          }
-        } else if (funcName.find("getc") != std::string::npos) {
-          // Handle "getc" like input function
-          for (unsigned argIdx = 0; argIdx < instPointer->arg_size();
-               ++argIdx) {
-            Value *argValue = instPointer->getArgOperand(argIdx);
-            DbgDeclareInst *dbgDeclare = getDbg(argValue, function);
-            if (dbgDeclare && dbgDeclare->getVariable()) {
-              std::string varName = dbgDeclare->getVariable()->getName().str();
-              int lineNo = dbgDeclare->getDebugLoc().getLine();
-
-              (*VarInfoMap)[varName] = VarInfo(varName, lineNo);
-              ioVar->insert(varName);
-            }
-          }
-        }
-      }
-    }
+std::string getBoundTerm(const std::set<std::string> &terms) {
+  if (terms.size() == 1) {
+    return *terms.begin();
+  }
+  std::string text = "min(";
+  for (auto it = terms.begin(); it != terms.end(); ++it) {
+    text += (it == terms.begin() ? "" : ", ") + *it;
   }
+  return text + ")";
 }
 
 /**
- * Pairs input variables with termination variables and prints or processes
- * them.
+ * Adds a monomial to a complexity unless a term of it already dominates the
+ * monomial, dropping the terms the monomial dominates. Every factor is at
+ * least one, so `n*m` dominates `n`.
  *
- * @param variableMap A map containing variable names and their information.
- * @param ioVar A set of IO variables that have been identified.
- * @param F The function being analyzed (used to get the function name).
+ * @param complexity The complexity to extend.
+ * @param monomial The monomial to add.
  */
-void pairInputTerminal(std::unordered_map<std::string, VarInfo> *variableMap,
-                       const std::unordered_set<std::string> *ioVar,
-                       Function *F) {
-  // Create JSON for the variables
-  Json functionJson;
-  functionJson["function"] =
-      F->getName().str(); // Use F.getName() to get the function name
-  Json variablesJson = createVariablesJson(variableMap, ioVar);
+void addMonomial(Complexity *complexity, const Monomial &monomial) {
+  for (const Monomial &term : *complexity) {
+    if (std::includes(term.begin(), term.end(), monomial.begin(),
+                      monomial.end())) {
+      return;
+    }
+  }
+  for (auto it = complexity->begin(); it != complexity->end();) {
+    if (std::includes(monomial.begin(), monomial.end(), it->begin(),
+                      it->end())) {
+      it = complexity->erase(it);
+    } else {
+      ++it;
+    }
+  }
+  complexity->insert(monomial);
+}
 
-  if (!variablesJson.empty()) {
-    functionJson["important_variables"] = variablesJson;
-    importantVar.push_back(
-        functionJson); // Assuming importantVar is defined elsewhere
+/**
+ * Returns the product of two complexities.
+ *
+ * @param lhs The first factor.
+ * @param rhs The second factor.
+ */
+Complexity multiplyComplexity(const Complexity &lhs, const Complexity &rhs) {
+  Complexity product;
+  for (const Monomial &left : lhs) {
+    for (const Monomial &right : rhs) {
+      Monomial term = left;
+      term.insert(right.begin(), right.end());
+      addMonomial(&product, term);
+    }
+  }
+  return product;
+}
+
+/**
+ * Formats a complexity in big-O notation, e.g. `O(n*m + len(fp))`.
+ *
+ * @param complexity The complexity to format.
+ */
+std::string formatComplexity(const Complexity &complexity) {
+  std::string text;
+  for (const Monomial &term : complexity) {
+    if (!text.empty()) {
+      text += " + ";
+    }
+    if (term.empty()) {
+      text += "1";
+    }
+    for (auto it = term.begin(); it != term.end(); ++it) {
+      text += (it == term.begin() ? "" : "*") + *it;
+    }
+  }
+  return "O(" + (text.empty() ? std::string("1") : text) + ")";
+}
+
+/**
+ * Resolves the calls in a function's complexity to the complexities of the
+ * callees. A callee that is not analyzed, or that is still being resolved
+ * (recursion, already accounted for by its depth), costs a constant.
+ *
+ * @param name The function to resolve.
+ * @param resolved The complexities resolved so far.
+ * @param active The functions being resolved.
+ * @return The complexity of the function, its callees included.
+ */
+Complexity resolveComplexity(const std::string &name,
+                             std::map<std::string, Complexity> *resolved,
+                             std::set<std::string> *active) {
+  auto cached = resolved->find(name);
+  if (cached != resolved->end()) {
+    return cached->second;
+  }
+  auto summary = complexitySummaries.find(name);
+  if (summary == complexitySummaries.end() || !active->insert(name).second) {
+    return {Monomial()};
+  }
+
+  Complexity result;
+  for (const Monomial &term : summary->second) {
+    Monomial features;
+    Complexity expanded = {Monomial()};
+    for (const std::string &factor : term) {
+      if (factor[0] == '@') {
+        expanded = multiplyComplexity(
+            expanded, resolveComplexity(factor.substr(1), resolved, active));
+      } else {
+        features.insert(factor);
+      }
+    }
+    for (const Monomial &product :
+         multiplyComplexity(expanded, {features})) {
+      addMonomial(&result, product);
+    }
+  }
+
+  active->erase(name);
+  (*resolved)[name] = result;
+  return result;
+}
+
+/**
+ * Writes the complexity of each reported function, its callees included,
+ * and the whole-program complexity from `main`. Runs once every function has
+ * been analyzed, since callers may precede their callees.
+ */
+void finalizeComplexity() {
+  std::map<std::string, Complexity> resolved;
+  for (Json &functionJson : importantVar) {
+    if (!functionJson.contains("function")) {
+      continue;
+    }
+    std::string name = functionJson["function"].get<std::string>();
+    if (complexitySummaries.count(name)) {
+      std::set<std::string> active;
+      functionJson["complexity"] =
+          formatComplexity(resolveComplexity(name, &resolved, &active));
+    }
+  }
+
+  if (complexitySummaries.count("main")) {
+    std::set<std::string> active;
+    Json programJson;
+    programJson["entry"] = "main";
+    programJson["complexity"] =
+        formatComplexity(resolveComplexity("main", &resolved, &active));
+    importantVar.push_back({{"program", programJson}});
+  }
+}
+
+/**
+ * Returns a C identifier for a name: `len(fp)` is `len_fp` and
+ * `game.board[1][2]` is `game_board_1_2`.
+ *
+ * @param name The name to convert.
+ */
+std::string getIdentifier(const std::string &name) {
+  std::string identifier;
+  for (char c : name) {
+    if (isalnum(static_cast<unsigned char>(c))) {
+      identifier += c;
+    } else if (!identifier.empty() && identifier.back() != '_') {
+      identifier += '_';
+    }
+  }
+  while (!identifier.empty() && identifier.back() == '_') {
+    identifier.pop_back();
+  }
+  if (identifier.empty() || isdigit(static_cast<unsigned char>(identifier[0]))) {
+    identifier = "_" + identifier;
+  }
+  return identifier;
+}
+
+/**
+ * Writes the cost oracle: `struct seminal_inputs`, with one field per input
+ * feature the program's cost depends on, a cost function per analyzed
+ * function, and `predict_cost()`, the cost of `main` in nanoseconds.
+ */
+void writeCostOracle() {
+  if (CostOracle.empty() || !costSummaries.count("main")) {
+    return;
+  }
+
+  // Costs and the scale are written with full precision, as tiny terms (or a
+  // tiny -seminal-cost-scale) would otherwise round to 0
+  std::ofstream file(CostOracle.getValue());
+  file << std::setprecision(17);
+  file << "/* Generated by the Seminal Input Detector: estimated cost of the "
+          "program, in\n"
+       << " * nanoseconds, from its seminal inputs. */\n\n"
+       << "#include <math.h>\n\n"
+       << "struct seminal_inputs {\n";
+  for (auto it = costFields.begin(); it != costFields.end(); ++it) {
+    file << "  double " << it->second << "; /* " << it->first << " */\n";
+  }
+  if (costFields.empty()) {
+    file << "  char unused;\n";
+  }
+  file << "};\n\n"
+       << "double predict_cost(const struct seminal_inputs *in);\n";
+
+  for (auto it = costSummaries.begin(); it != costSummaries.end(); ++it) {
+    file << "static double cost_" << getIdentifier(it->first)
+         << "(const struct seminal_inputs *in);\n";
+  }
+
+  for (auto it = costSummaries.begin(); it != costSummaries.end(); ++it) {
+    file << "\nstatic double cost_" << getIdentifier(it->first)
+         << "(const struct seminal_inputs *in) {\n"
+         << "  double cost = 0;\n";
+    for (auto term = it->second.begin(); term != it->second.end(); ++term) {
+      const std::string &factors = term->first.first;
+      const std::string &callee = term->first.second;
+      if (!callee.empty() && !costSummaries.count(callee)) {
+        continue;
+      }
+      file << "  cost += " << term->second;
+      if (!factors.empty()) {
+        file << " * " << factors;
+      }
+      if (!callee.empty()) {
+        file << " * cost_" << getIdentifier(callee) << "(in)";
+      }
+      file << ";\n";
+    }
+    file << "  return cost;\n}\n";
+  }
+
+  file << "\ndouble predict_cost(const struct seminal_inputs *in) {\n"
+       << "  return " << CostScale.getValue()
+       << " * cost_main(in);\n}\n";
+  file.close();
+}
+
+// ---- END IO FUNCTIONS ----
+
+// ----  Core Functions ----
+
+/**
+ * Strips integer conversions (e.g. `char` to `int` before comparing with EOF).
+ *
+ * @param value The value to strip.
+ * @return The value before any casts.
+ */
+Value *stripIntCasts(Value *value) {
+  while (CastInst *cast = dyn_cast<CastInst>(value)) {
+    value = cast->getOperand(0);
+  }
+  return value;
+}
+
+/**
+ * Returns true if a value is an induction variable of a loop: a variable
+ * (or header phi) the loop steps by a constant on every iteration, or its
+ * stepped value as compared in the latch of a rotated loop.
+ *
+ * @param value The value compared or used as an index.
+ * @param loop The loop to check against.
+ */
+bool isInductionVariable(Value *value, Loop *loop) {
+  value = stripIntCasts(value);
+
+  // A constant step applied to the variable itself
+  auto isStep = [](Value *step, function_ref<bool(Value *)> self) {
+    BinaryOperator *binary = dyn_cast<BinaryOperator>(stripIntCasts(step));
+    if (!binary || (binary->getOpcode() != Instruction::Add &&
+                    binary->getOpcode() != Instruction::Sub)) {
+      return false;
+    }
+    for (unsigned i = 0; i < 2; ++i) {
+      if (isa<ConstantInt>(binary->getOperand(1 - i)) &&
+          self(stripIntCasts(binary->getOperand(i)))) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // A header phi stepped along the latch (SSA form)
+  auto isInductionPhi = [loop, &isStep](Value *v) {
+    PHINode *phi = dyn_cast<PHINode>(v);
+    if (!phi || phi->getParent() != loop->getHeader()) {
+      return false;
+    }
+    for (Value *incoming : phi->incoming_values()) {
+      if (isStep(incoming, [phi](Value *self) { return self == phi; })) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // Rotated loops compare the stepped value (`i + 1 < n`) in the latch
+  if (isInductionPhi(value) ||
+      isStep(value, [&isInductionPhi](Value *self) {
+        return isInductionPhi(self);
+      })) {
+    return true;
+  }
+
+  LoadInst *load = dyn_cast<LoadInst>(value);
+  if (!load || !loop->contains(load)) {
+    return false;
+  }
+  Value *pointer = load->getPointerOperand()->stripPointerCasts();
+  auto loadsPointer = [pointer](Value *v) {
+    LoadInst *other = dyn_cast<LoadInst>(v);
+    return other && other->getPointerOperand()->stripPointerCasts() == pointer;
+  };
+  for (BasicBlock *block : loop->blocks()) {
+    for (Instruction &inst : *block) {
+      StoreInst *store = dyn_cast<StoreInst>(&inst);
+      if (store && store->getPointerOperand()->stripPointerCasts() == pointer &&
+          isStep(store->getValueOperand(), loadsPointer)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * Returns true if a constant marks the end of input data compared with it:
+ * EOF, a newline, or the NUL terminating a `char` string.
+ *
+ * @param constant The possibly constant side of a comparison.
+ * @param other The other side of the comparison.
+ */
+bool isTerminatorConstant(Value *constant, Value *other) {
+  ConstantInt *value = dyn_cast<ConstantInt>(constant);
+  if (!value) {
+    return false;
+  }
+  if (value->isMinusOne() || value->equalsInt('\n')) {
+    return true;
+  }
+  return value->isZero() && stripIntCasts(other)->getType()->isIntegerTy(8);
+}
+
+/**
+ * Returns the buffer enclosing an array element: the location with its
+ * trailing element steps removed.
+ *
+ * @param location An abstract location.
+ * @param locations The table of locations.
+ */
+unsigned stripElementSteps(unsigned location, LocationTable *locations) {
+  while (location != LocationTable::NoLocation) {
+    const LocationTable::Entry &entry = locations->get(location);
+    if (entry.kind != LocationTable::Element &&
+        entry.kind != LocationTable::AnyElement) {
+      break;
+    }
+    location = entry.parent;
+  }
+  return location;
+}
+
+/**
+ * Adds a variable to a map, keeping the most specific feature kind when it
+ * is reached from several sinks (a length over a count over a value).
+ *
+ * @param vMap The map of reported variables.
+ * @param info The variable to add.
+ */
+void mergeVariable(std::unordered_map<std::string, VarInfo> *vMap,
+                   const VarInfo &info) {
+  auto inserted = vMap->emplace(info.name, info);
+  if (!inserted.second && info.feature > inserted.first->second.feature) {
+    inserted.first->second.feature = info.feature;
+  }
+}
+
+/**
+ * Traces one operand of a sink and records what it reaches as a feature of
+ * the given kind. For a length, the compared bytes themselves are content,
+ * not a feature: a byte of an array stands for the array, and a scalar byte
+ * variable is not reported.
+ *
+ * @param operand The operand to trace.
+ * @param feature The feature kind of what the operand reaches.
+ * @param seen The values visited so far; extended with this walk.
+ * @param vMap A map to store variables and their information.
+ * @param ctx The analyses of the function in which the sink resides.
+ * @param parameters If given, collects the parameters of the function the
+ * operand depends on.
+ */
+void traceFeature(Value *operand, FeatureKind feature, std::set<Value *> *seen,
+                  std::unordered_map<std::string, VarInfo> *vMap,
+                  DefUseContext *ctx,
+                  std::set<Argument *> *parameters = nullptr) {
+  ModuleState *state = ctx->module;
+
+  // Each operand is walked on its own so its variables can be classified
+  std::set<Value *> visited;
+  std::unordered_map<std::string, VarInfo> reached;
+  getDefUseChain(operand, &visited, &reached, ctx);
+  seen->insert(visited.begin(), visited.end());
+
+  if (parameters) {
+    for (Value *value : visited) {
+      Argument *arg = dyn_cast<Argument>(value);
+      if (arg && arg->getParent() == ctx->F) {
+        parameters->insert(arg);
+      }
+    }
+  }
+
+  std::set<unsigned> byteLocations;
+  if (feature == FeatureKind::Length) {
+    Value *byte = stripIntCasts(operand);
+    if (LoadInst *load = dyn_cast<LoadInst>(byte)) {
+      for (unsigned location :
+           resolveLocations(load->getPointerOperand(), state->PTA.get(),
+                            &state->locations)) {
+        byteLocations.insert(location);
+      }
+    } else if (isa<CallBase>(byte)) {
+      // SSA form: the byte is the input call's result itself
+      byteLocations.insert(state->locations.getRoot(byte));
+    }
+  }
+
+  for (auto it = reached.begin(); it != reached.end(); ++it) {
+    VarInfo info = it->second;
+    info.feature = feature;
+    if (byteLocations.count(info.location)) {
+      unsigned buffer = stripElementSteps(info.location, &state->locations);
+      if (buffer == info.location ||
+          !describeLocation(buffer, state, &info.name, &info.line)) {
+        continue;
+      }
+      info.location = buffer;
+    }
+    mergeVariable(vMap, info);
+  }
+}
+
+/**
+ * Traces a loop exit condition and classifies what it reaches. A comparison
+ * of input bytes with EOF, a newline or NUL makes the loop run once per byte,
+ * so the buffer or stream the bytes come from is a length feature. A bound
+ * compared against an induction variable is a count; anything else is a
+ * value.
+ *
+ * @param condition The exit condition of the loop.
+ * @param loop The loop the condition exits.
+ * @param seen The values visited so far; extended with this walk.
+ * @param vMap A map to store variables and their information.
+ * @param ctx The analyses of the function in which the loop resides.
+ */
+void classifyLoopExit(Value *condition, Loop *loop, std::set<Value *> *seen,
+                      std::unordered_map<std::string, VarInfo> *vMap,
+                      DefUseContext *ctx) {
+  Instruction *inst = dyn_cast<Instruction>(condition);
+  if (!inst) {
+    return;
+  }
+
+  for (unsigned i = 0; i < inst->getNumOperands(); ++i) {
+    Value *operand = inst->getOperand(i);
+    Value *other = inst->getNumOperands() == 2 ? inst->getOperand(1 - i)
+                                               : nullptr;
+
+    FeatureKind feature = FeatureKind::Value;
+    if (isa<ICmpInst>(inst) && other) {
+      if (isa<ConstantInt>(operand)) {
+        continue;
+      }
+      if (isTerminatorConstant(other, operand)) {
+        feature = FeatureKind::Length;
+      } else if (isInductionVariable(other, loop)) {
+        feature = FeatureKind::Count;
+      }
+    }
+
+    traceFeature(operand, feature, seen, vMap, ctx);
+  }
+}
+
+/**
+ * Finds loops that copy input bytes into a buffer at an induction-variable
+ * index (`str1[len++] = c`). The buffer then holds input, and its length is
+ * what the loop's trip count depends on.
+ *
+ * @param loop The loop to scan.
+ * @param vMap A map to store variables and their information.
+ * @param ctx The analyses of the function in which the loop resides.
+ */
+void findBufferFills(Loop *loop, std::unordered_map<std::string, VarInfo> *vMap,
+                     DefUseContext *ctx) {
+  ModuleState *state = ctx->module;
+  LocationTable *locations = &state->locations;
+  for (BasicBlock *block : loop->blocks()) {
+    for (Instruction &inst : *block) {
+      StoreInst *store = dyn_cast<StoreInst>(&inst);
+      GEPOperator *gep =
+          store ? dyn_cast<GEPOperator>(store->getPointerOperand()) : nullptr;
+      if (!gep || gep->getNumIndices() == 0 ||
+          !isInductionVariable(*(gep->idx_end() - 1), loop)) {
+        continue;
+      }
+
+      // The stored byte must come from input
+      Value *byte = stripIntCasts(store->getValueOperand());
+      bool fromInput = false;
+      if (LoadInst *load = dyn_cast<LoadInst>(byte)) {
+        for (unsigned location :
+             resolveLocations(load->getPointerOperand(), state->PTA.get(),
+                              locations)) {
+          fromInput |= locations->overlapsInput(location);
+        }
+      } else if (CallBase *call = dyn_cast<CallBase>(byte)) {
+        const SeminalLibraryModel *model =
+            SeminalLibraryCatalog::get().lookup(call);
+        fromInput = model && model->isSource();
+      }
+      if (!fromInput) {
+        continue;
+      }
+
+      for (unsigned location :
+           resolveLocations(gep, state->PTA.get(), locations)) {
+        unsigned buffer = stripElementSteps(location, locations);
+        VarInfo info;
+        if (!describeLocation(buffer, state, &info.name, &info.line)) {
+          continue;
+        }
+        locations->markInput(buffer);
+        info.location = buffer;
+        info.feature = FeatureKind::Length;
+        mergeVariable(vMap, info);
+      }
+    }
+  }
+}
+
+/**
+ * Enumerates the dynamic decision points of a function: the conditional exits
+ * of every loop (nested ones included), switches, selects, indirect calls,
+ * the sizes of heap allocations and variable-length arrays, and, in a
+ * recursive function, the branches deciding whether it recurses. Both the
+ * direct and the implicit-flow analyses start from this list.
+ *
+ * @param F The function to scan.
+ * @param LI The LoopInfo of F.
+ * @param CD The control dependences of F.
+ * @param state The module state, holding the recursive SCCs.
+ * @return The sinks of F, loop exits first.
+ */
+std::vector<Sink> collectSinks(Function *F, LoopInfo *LI,
+                               const SeminalControlDependence *CD,
+                               ModuleState *state) {
+  std::vector<Sink> sinks;
+
+  for (Loop *loop : LI->getLoopsInPreorder()) {
+    SmallVector<BasicBlock *, 4> exiting;
+    loop->getExitingBlocks(exiting);
+    for (BasicBlock *block : exiting) {
+      BranchInst *BI = dyn_cast<BranchInst>(block->getTerminator());
+      if (BI && BI->isConditional()) {
+        sinks.push_back({Sink::LoopExit, BI, BI->getCondition(), loop});
+      }
+    }
+  }
+
+  for (Instruction &inst : instructions(*F)) {
+    if (SwitchInst *SI = dyn_cast<SwitchInst>(&inst)) {
+      sinks.push_back({Sink::Switch, SI, SI->getCondition(), nullptr});
+    } else if (SelectInst *SI = dyn_cast<SelectInst>(&inst)) {
+      sinks.push_back({Sink::Select, SI, SI->getCondition(), nullptr});
+    } else if (AllocaInst *AI = dyn_cast<AllocaInst>(&inst)) {
+      // Variable-length arrays
+      if (!isa<Constant>(AI->getArraySize())) {
+        sinks.push_back({Sink::Allocation, AI, AI->getArraySize(), nullptr});
+      }
+    } else if (CallBase *call = dyn_cast<CallBase>(&inst)) {
+      if (call->isIndirectCall()) {
+        sinks.push_back(
+            {Sink::IndirectCall, call, call->getCalledOperand(), nullptr});
+      }
+
+      // The size factors of one allocation are kept adjacent
+      const SeminalLibraryModel *model =
+          SeminalLibraryCatalog::get().lookup(call);
+      if (model && model->isAllocation()) {
+        for (unsigned index : model->sizeArguments) {
+          if (index < call->arg_size()) {
+            sinks.push_back(
+                {Sink::Allocation, call, call->getArgOperand(index), nullptr});
+          }
+        }
+      }
+    }
+  }
+
+  // The termination test of a recursion guards its recursive calls
+  auto scc = state->recursiveSCCOf.find(F);
+  if (scc != state->recursiveSCCOf.end()) {
+    std::set<Instruction *> tests;
+    for (Instruction &inst : instructions(*F)) {
+      CallBase *call = dyn_cast<CallBase>(&inst);
+      Function *callee = call ? call->getCalledFunction() : nullptr;
+      auto calleeSCC = callee ? state->recursiveSCCOf.find(callee)
+                              : state->recursiveSCCOf.end();
+      if (calleeSCC == state->recursiveSCCOf.end() ||
+          calleeSCC->second != scc->second) {
+        continue;
+      }
+
+      for (Instruction *terminator :
+           CD->getControllingTerminators(call->getParent())) {
+        Value *condition = nullptr;
+        if (BranchInst *BI = dyn_cast<BranchInst>(terminator)) {
+          condition = BI->isConditional() ? BI->getCondition() : nullptr;
+        } else if (SwitchInst *SI = dyn_cast<SwitchInst>(terminator)) {
+          condition = SI->getCondition();
+        }
+        if (condition && tests.insert(terminator).second) {
+          sinks.push_back({Sink::RecursionExit, terminator, condition, nullptr});
+        }
+      }
+    }
+  }
+
+  return sinks;
+}
+
+/**
+ * Processes the sinks of a function, tracking the variables that decide
+ * them. Loop exits are classified as value, count or length features, and
+ * recursion tests as recursion depths; the operands of switches, selects and
+ * indirect calls are values.
+ *
+ * @param sinks The sinks of the function.
+ * @param LI The LoopInfo of the function, scanned for buffer fills.
+ * @param seen A set of values that have already been visited.
+ * @param vMap A map to store variables and their information.
+ * @param ctx The analyses of the function in which the sinks reside.
+ * @param recursionParameters Collects the parameters the recursion tests of
+ * the function depend on.
+ * @param loopBounds Collects, per loop, the input features its exits reach.
+ * @param recursionBounds Collects the input features the recursion tests
+ * reach.
+ * @param inputDecisions Collects the sinks, other than allocations, that an
+ * input-written variable reaches.
+ */
+void processSinks(const std::vector<Sink> &sinks, LoopInfo *LI,
+                  std::set<Value *> *seen,
+                  std::unordered_map<std::string, VarInfo> *vMap,
+                  DefUseContext *ctx,
+                  std::set<Argument *> *recursionParameters,
+                  std::map<Loop *, std::set<std::string>> *loopBounds,
+                  std::set<std::string> *recursionBounds,
+                  std::set<Instruction *> *inputDecisions) {
+  LocationTable *locations = &ctx->module->locations;
+  for (Loop *loop : LI->getLoopsInPreorder()) {
+    findBufferFills(loop, vMap, ctx);
+  }
+
+  for (const Sink &sink : sinks) {
+    if (sink.kind == Sink::Allocation) {
+      // Reported per allocation, see processAllocations
+      continue;
+    } else if (sink.kind == Sink::LoopExit) {
+      std::unordered_map<std::string, VarInfo> exitMap;
+      classifyLoopExit(sink.operand, sink.loop, seen, &exitMap, ctx);
+      for (auto it = exitMap.begin(); it != exitMap.end(); ++it) {
+        mergeVariable(vMap, it->second);
+        if (locations->overlapsInput(it->second.location)) {
+          (*loopBounds)[sink.loop].insert(getFeatureTerm(it->second));
+          inputDecisions->insert(sink.inst);
+        }
+      }
+    } else if (sink.kind == Sink::RecursionExit) {
+      std::unordered_map<std::string, VarInfo> testMap;
+      traceFeature(sink.operand, FeatureKind::Depth, seen, &testMap, ctx,
+                   recursionParameters);
+      for (auto it = testMap.begin(); it != testMap.end(); ++it) {
+        mergeVariable(vMap, it->second);
+        if (locations->overlapsInput(it->second.location)) {
+          recursionBounds->insert(getFeatureTerm(it->second));
+          inputDecisions->insert(sink.inst);
+        }
+      }
+    } else {
+      std::unordered_map<std::string, VarInfo> valueMap;
+      traceFeature(sink.operand, FeatureKind::Value, seen, &valueMap, ctx);
+      for (auto it = valueMap.begin(); it != valueMap.end(); ++it) {
+        mergeVariable(vMap, it->second);
+        if (locations->overlapsInput(it->second.location)) {
+          inputDecisions->insert(sink.inst);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Returns the source-level name of a value in a size expression: the
+ * variable it was loaded from, or the variable its dbg.value describes.
+ *
+ * @param value The value to name.
+ * @param ctx The analyses of the function being analyzed.
+ */
+std::string getSourceName(Value *value, DefUseContext *ctx) {
+  ModuleState *state = ctx->module;
+  std::string name;
+  int line = -1;
+
+  value = stripIntCasts(value);
+  if (LoadInst *load = dyn_cast<LoadInst>(value)) {
+    for (unsigned location :
+         resolveLocations(load->getPointerOperand(), state->PTA.get(),
+                          &state->locations)) {
+      if (describeLocation(location, state, &name, &line)) {
+        return name;
+      }
+    }
+  } else if (isa<CallBase>(value) &&
+             describeLocation(state->locations.getRoot(value), state, &name,
+                              &line)) {
+    return name;
+  }
+
+  SmallVector<DbgValueInst *, 1> dbgValues;
+  findDbgValues(dbgValues, value);
+  if (!dbgValues.empty() && dbgValues.front()->getVariable()) {
+    return dbgValues.front()->getVariable()->getName().str();
+  }
+
+  std::string operand;
+  raw_string_ostream stream(operand);
+  value->printAsOperand(stream, false);
+  return stream.str();
+}
+
+/**
+ * Formats a ScalarEvolution expression as C-like source text, naming its
+ * unknowns after source variables (e.g. `(4 * n)`).
+ *
+ * @param expression The expression to format.
+ * @param ctx The analyses of the function being analyzed.
+ */
+std::string formatExpression(const SCEV *expression, DefUseContext *ctx) {
+  if (const SCEVConstant *constant = dyn_cast<SCEVConstant>(expression)) {
+    return std::to_string(constant->getAPInt().getSExtValue());
+  }
+  if (const SCEVCastExpr *cast = dyn_cast<SCEVCastExpr>(expression)) {
+    return formatExpression(cast->getOperand(0), ctx);
+  }
+  if (const SCEVUnknown *unknown = dyn_cast<SCEVUnknown>(expression)) {
+    return getSourceName(unknown->getValue(), ctx);
+  }
+  if (const SCEVUDivExpr *division = dyn_cast<SCEVUDivExpr>(expression)) {
+    return "(" + formatExpression(division->getLHS(), ctx) + " / " +
+           formatExpression(division->getRHS(), ctx) + ")";
+  }
+
+  const char *separator = nullptr;
+  if (isa<SCEVAddExpr>(expression)) {
+    separator = " + ";
+  } else if (isa<SCEVMulExpr>(expression)) {
+    separator = " * ";
+  } else if (isa<SCEVMinMaxExpr>(expression)) {
+    separator = isa<SCEVSMaxExpr>(expression) || isa<SCEVUMaxExpr>(expression)
+                    ? " max "
+                    : " min ";
+  }
+  if (!separator) {
+    std::string text;
+    raw_string_ostream stream(text);
+    expression->print(stream);
+    return stream.str();
+  }
+
+  const SCEVNAryExpr *nary = cast<SCEVNAryExpr>(expression);
+  std::string text = "(";
+  for (unsigned i = 0; i < nary->getNumOperands(); ++i) {
+    if (i) {
+      text += separator;
+    }
+    text += formatExpression(nary->getOperand(i), ctx);
+  }
+  return text + ")";
+}
+
+/**
+ * Reports the allocations whose size depends on input, with the input
+ * variables and a symbolic size in bytes, so peak memory can be predicted
+ * from the input before a run.
+ *
+ * @param sinks The sinks of the function; Allocation ones are processed.
+ * @param SE The ScalarEvolution of the function.
+ * @param seen The values visited so far; extended with these walks.
+ * @param ctx The analyses of the function being analyzed.
+ * @return A JSON array of the input-dependent allocations.
+ */
+Json processAllocations(const std::vector<Sink> &sinks, ScalarEvolution *SE,
+                        std::set<Value *> *seen, DefUseContext *ctx) {
+  Json allocationsJson = Json::array();
+  const DataLayout &DL = ctx->F->getParent()->getDataLayout();
+
+  for (size_t i = 0; i < sinks.size();) {
+    if (sinks[i].kind != Sink::Allocation) {
+      ++i;
+      continue;
+    }
+
+    // Multiply the size factors of the allocation (e.g. calloc's two)
+    Instruction *site = sinks[i].inst;
+    std::unordered_map<std::string, VarInfo> reached;
+    const SCEV *size = nullptr;
+    for (; i < sinks.size() && sinks[i].inst == site; ++i) {
+      Value *factor = sinks[i].operand;
+      traceFeature(factor, FeatureKind::Value, seen, &reached, ctx);
+      if (!SE->isSCEVable(factor->getType())) {
+        continue;
+      }
+      const SCEV *term = SE->getSCEV(factor);
+      size = size ? SE->getMulExpr(
+                        size, SE->getTruncateOrZeroExtend(term, size->getType()))
+                  : term;
+    }
+
+    // A variable-length array holds its element count times the element size
+    std::string kind = "vla";
+    if (AllocaInst *AI = dyn_cast<AllocaInst>(site)) {
+      if (size) {
+        size = SE->getMulExpr(
+            size, SE->getConstant(size->getType(),
+                                  DL.getTypeAllocSize(AI->getAllocatedType())));
+      }
+    } else {
+      kind = SeminalLibraryCatalog::normalizeName(
+                 cast<CallBase>(site)->getCalledFunction()->getName())
+                 .str();
+    }
+
+    Json variablesJson = createVariablesJson(&reached, &ctx->module->locations);
+    if (variablesJson.empty()) {
+      continue;
+    }
+
+    Json allocationJson;
+    allocationJson["kind"] = kind;
+    allocationJson["line"] =
+        site->getDebugLoc() ? int(site->getDebugLoc().getLine()) : -1;
+    allocationJson["size"] = size ? formatExpression(size, ctx) : "?";
+    allocationJson["variables"] = variablesJson;
+    allocationsJson.push_back(allocationJson);
+  }
+
+  return allocationsJson;
+}
+
+/**
+ * Follows input influence along control-dependence edges: the conditions of
+ * the branches that decide whether a sink, or any definition feeding it,
+ * executes are traced as well. What they reach is recorded separately from
+ * the direct def-use results, with a visited set of its own, so a condition
+ * the direct walk already passed through is still reported as implicit. Each
+ * condition is traced once, and only the definitions it newly reaches are
+ * looked up for their own guards.
+ *
+ * @param sinks The sinks of the analyzed function.
+ * @param CD The control dependences of the analyzed function.
+ * @param seen The values visited by the direct walk.
+ * @param implicitMap A map to store the implicitly reached variables.
+ * @param ctx The analyses of the function in which the loops reside.
+ */
+void processImplicitFlows(const std::vector<Sink> &sinks,
+                          const SeminalControlDependence *CD,
+                          const std::set<Value *> &seen,
+                          std::unordered_map<std::string, VarInfo> *implicitMap,
+                          DefUseContext *ctx) {
+  std::set<const BasicBlock *> reached;
+  std::vector<const BasicBlock *> worklist;
+  auto reach = [&](const BasicBlock *BB) {
+    if (reached.insert(BB).second) {
+      worklist.push_back(BB);
+    }
+  };
+  auto reachDefinition = [&](Value *value) {
+    Instruction *inst = dyn_cast<Instruction>(value);
+    if (inst && inst->getFunction() == ctx->F) {
+      reach(inst->getParent());
+    }
+  };
+
+  // Every block holding a sink or a definition feeding one may be guarded
+  for (const Sink &sink : sinks) {
+    reach(sink.inst->getParent());
+  }
+  for (Value *value : seen) {
+    reachDefinition(value);
+  }
+
+  std::set<Value *> visited;
+  while (!worklist.empty()) {
+    const BasicBlock *BB = worklist.back();
+    worklist.pop_back();
+
+    for (Instruction *terminator : CD->getControllingTerminators(BB)) {
+      reach(terminator->getParent());
+
+      Value *condition = nullptr;
+      if (BranchInst *BI = dyn_cast<BranchInst>(terminator)) {
+        condition = BI->isConditional() ? BI->getCondition() : nullptr;
+      } else if (SwitchInst *SI = dyn_cast<SwitchInst>(terminator)) {
+        condition = SI->getCondition();
+      }
+      if (!condition || visited.count(condition)) {
+        continue;
+      }
+
+      // The definitions the condition newly reaches may be guarded in turn
+      std::set<Value *> found;
+      getDefUseChain(condition, &found, implicitMap, ctx);
+      for (Value *value : found) {
+        if (visited.insert(value).second) {
+          reachDefinition(value);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Adds the source lines of a block's instructions in a given file; code
+ * inlined from another file is left out.
+ *
+ * @param block The block.
+ * @param file The file the lines are wanted in.
+ * @param lines The lines found.
+ */
+void addSourceLines(const BasicBlock *block, StringRef file,
+                    std::set<unsigned> *lines) {
+  for (const Instruction &inst : *block) {
+    const DebugLoc &location = inst.getDebugLoc();
+    if (location && location.getLine() &&
+        location->getFilename() == file && !isa<DbgInfoIntrinsic>(inst)) {
+      lines->insert(location.getLine());
+    }
+  }
+}
+
+/**
+ * Reports the decisions of a function that input reaches, and the lines
+ * whose execution they decide: the blocks control dependent on an
+ * input-reached loop exit, switch or recursion test.
+ *
+ * @param F The function.
+ * @param sinks The sinks of F.
+ * @param inputDecisions The sinks that an input-written variable reaches.
+ * @param CD The control dependences of F.
+ * @return The "decisions" (kind and line of each) and "controlled_lines"
+ * of F, either left out when empty.
+ */
+Json summarizeDecisions(Function *F, const std::vector<Sink> &sinks,
+                        const std::set<Instruction *> &inputDecisions,
+                        const SeminalControlDependence *CD) {
+  Json details = Json::object();
+  DISubprogram *subprogram = F->getSubprogram();
+  if (!subprogram || inputDecisions.empty()) {
+    return details;
+  }
+  StringRef file = subprogram->getFilename();
+
+  Json decisionsJson = Json::array();
+  std::set<Instruction *> reported;
+  static const char *const kinds[] = {"loop_exit",     "switch",
+                                      "select",        "indirect_call",
+                                      "allocation",    "recursion_exit"};
+  for (const Sink &sink : sinks) {
+    if (!inputDecisions.count(sink.inst) ||
+        !reported.insert(sink.inst).second) {
+      continue;
+    }
+    Json decisionJson;
+    decisionJson["kind"] = kinds[sink.kind];
+    decisionJson["line"] =
+        sink.inst->getDebugLoc() ? sink.inst->getDebugLoc().getLine() : 0;
+    decisionsJson.push_back(decisionJson);
+  }
+  details["decisions"] = decisionsJson;
+
+  std::set<unsigned> lines;
+  for (BasicBlock &block : *F) {
+    for (Instruction *terminator : CD->getControllingTerminators(&block)) {
+      if (inputDecisions.count(terminator)) {
+        addSourceLines(&block, file, &lines);
+        break;
+      }
+    }
+  }
+  if (!lines.empty()) {
+    details["controlled_lines"] = lines;
+  }
+  return details;
+}
+
+/**
+ * Estimates the complexity of a function in its input features. A block
+ * costs the product of the bounds of the loops around it, and a call the
+ * block's cost times the callee's complexity (resolved once the module is
+ * done); the function costs the dominant sum of those. A loop whose trip
+ * count is a constant costs nothing, and one whose exits reach no input
+ * feature is taken as bounded. A recursive function is multiplied by its
+ * recursion depth, or by `2^depth` when it recurses more than once.
+ *
+ * @param F The function to estimate.
+ * @param LI The LoopInfo of F.
+ * @param SE The ScalarEvolution of F, giving the symbolic trip counts.
+ * @param loopBounds The input features each loop's exits reach.
+ * @param recursionBounds The input features the recursion tests reach.
+ * @param ctx The analyses of F.
+ * @return A JSON array of the input-bounded loops, with their bounds and
+ * symbolic trip counts.
+ */
+Json summarizeComplexity(
+    Function *F, LoopInfo *LI, ScalarEvolution *SE,
+    const std::map<Loop *, std::set<std::string>> &loopBounds,
+    const std::set<std::string> &recursionBounds, DefUseContext *ctx) {
+  ModuleState *state = ctx->module;
+  Json loopsJson = Json::array();
+
+  std::map<Loop *, std::string> factors;
+  for (Loop *loop : LI->getLoopsInPreorder()) {
+    auto bounds = loopBounds.find(loop);
+    const SCEV *backedges = SE->getBackedgeTakenCount(loop);
+    if (bounds == loopBounds.end() || isa<SCEVConstant>(backedges)) {
+      continue;
+    }
+    factors[loop] = getBoundTerm(bounds->second);
+
+    Json loopJson;
+    loopJson["line"] = loop->getStartLoc() ? loop->getStartLoc().getLine() : 0;
+    loopJson["depth"] = loop->getLoopDepth();
+    loopJson["bound"] = factors[loop];
+    if (DISubprogram *subprogram = F->getSubprogram()) {
+      std::set<unsigned> bodyLines;
+      for (const BasicBlock *block : loop->blocks()) {
+        addSourceLines(block, subprogram->getFilename(), &bodyLines);
+      }
+      loopJson["body_lines"] = bodyLines;
+    }
+    if (!isa<SCEVCouldNotCompute>(backedges)) {
+      loopJson["trip_count"] = formatExpression(
+          SE->getAddExpr(backedges, SE->getOne(backedges->getType())), ctx);
+    }
+    loopsJson.push_back(loopJson);
+  }
+
+  auto scc = state->recursiveSCCOf.find(F);
+  unsigned recursiveCalls = 0;
+  Complexity complexity;
+  for (BasicBlock &block : *F) {
+    Monomial cost;
+    for (Loop *loop = LI->getLoopFor(&block); loop;
+         loop = loop->getParentLoop()) {
+      auto factor = factors.find(loop);
+      if (factor != factors.end()) {
+        cost.insert(factor->second);
+      }
+    }
+    addMonomial(&complexity, cost);
+
+    for (Instruction &inst : block) {
+      CallBase *call = dyn_cast<CallBase>(&inst);
+      Function *callee = call ? call->getCalledFunction() : nullptr;
+      if (!callee || callee->isDeclaration()) {
+        continue;
+      }
+      auto calleeSCC = state->recursiveSCCOf.find(callee);
+      if (scc != state->recursiveSCCOf.end() &&
+          calleeSCC != state->recursiveSCCOf.end() &&
+          calleeSCC->second == scc->second) {
+        ++recursiveCalls;
+        continue;
+      }
+      Monomial callCost = cost;
+      callCost.insert("@" + callee->getName().str());
+      addMonomial(&complexity, callCost);
+    }
+  }
+
+  if (recursiveCalls && !recursionBounds.empty()) {
+    std::string depth = getBoundTerm(recursionBounds);
+    Monomial recursion = {recursiveCalls > 1 ? "2^" + depth : depth};
+    complexity = multiplyComplexity(complexity, {recursion});
+  }
+
+  complexitySummaries[F->getName().str()] = complexity;
+  return loopsJson;
+}
+
+/**
+ * Returns the C expression of a loop or recursion bound in the cost oracle,
+ * over the fields of `in` holding its features, adding the fields.
+ *
+ * @param features The feature terms bounding the loop or recursion.
+ */
+std::string getCostBound(const std::set<std::string> &features) {
+  std::string bound;
+  for (const std::string &feature : features) {
+    auto inserted = costFields.emplace(feature, "");
+    std::string &field = inserted.first->second;
+    if (inserted.second) {
+      std::string base = getIdentifier(feature);
+      field = base;
+      for (unsigned suffix = 2; !costFieldNames.insert(field).second;
+           ++suffix) {
+        field = base + "_" + std::to_string(suffix);
+      }
+    }
+    bound = bound.empty() ? "in->" + field
+                          : "fmin(" + bound + ", in->" + field + ")";
   }
+  return bound;
 }
 
 /**
- * Handles the detection and analysis of variables in a function, including
- * allocations and stores.
+ * Estimates the cost of a function for the cost oracle. Each block costs the
+ * target's latency of its instructions, times the trip counts of the loops
+ * around it: the input bound of a loop, or its constant trip count. A call
+ * to a function in the module adds the callee's cost as many times. A
+ * recursive function is scaled like its complexity.
  *
- * @param function The function in which variable information is to be handled.
- * @param VarInfoMap A map for storing variable information.
- * @param seenValues A set of visited values to avoid re-processing.
+ * @param F The function to estimate.
+ * @param LI The LoopInfo of F.
+ * @param SE The ScalarEvolution of F, giving the constant trip counts.
+ * @param TTI The target's instruction costs.
+ * @param loopBounds The input features each loop's exits reach.
+ * @param recursionBounds The input features the recursion tests reach.
+ * @param state The module state, holding the recursive SCCs.
  */
-void handleFunctionVariables(
-    Function *function, std::unordered_map<std::string, VarInfo> *VarInfoMap,
-    std::set<Value *> *seenValues) {
-  for (auto BBIt = function->begin(); BBIt != function->end(); ++BBIt) {
-    BasicBlock &basicBlock = *BBIt;
-    // Loop over all instructions inside the basic block
-    for (auto IIt = basicBlock.begin(); IIt != basicBlock.end(); ++IIt) {
-      Instruction &instruction = *IIt;
+void summarizeCost(Function *F, LoopInfo *LI, ScalarEvolution *SE,
+                   TargetTransformInfo *TTI,
+                   const std::map<Loop *, std::set<std::string>> &loopBounds,
+                   const std::set<std::string> &recursionBounds,
+                   ModuleState *state) {
+  std::map<Loop *, std::string> tripCounts;
+  for (Loop *loop : LI->getLoopsInPreorder()) {
+    auto bounds = loopBounds.find(loop);
+    if (unsigned constant = SE->getSmallConstantTripCount(loop)) {
+      tripCounts[loop] = std::to_string(constant);
+    } else if (bounds != loopBounds.end()) {
+      tripCounts[loop] = getCostBound(bounds->second);
+    }
+  }
+
+  auto scc = state->recursiveSCCOf.find(F);
+  unsigned recursiveCalls = 0;
+  CostSummary summary;
+  for (BasicBlock &block : *F) {
+    std::string factors;
+    for (Loop *loop = LI->getLoopFor(&block); loop;
+         loop = loop->getParentLoop()) {
+      auto tripCount = tripCounts.find(loop);
+      if (tripCount != tripCounts.end()) {
+        factors += (factors.empty() ? "" : " * ") + tripCount->second;
+      }
+    }
 
-      // Handle allocations
-      handleAllocations(&instruction, function, VarInfoMap);
+    for (Instruction &inst : block) {
+      InstructionCost cost =
+          TTI->getInstructionCost(&inst, TargetTransformInfo::TCK_Latency);
+      if (cost.isValid()) {
+        summary[{factors, ""}] += *cost.getValue();
+      }
 
-      // Handle stores
-      handleStores(&instruction, seenValues, VarInfoMap, function);
+      CallBase *call = dyn_cast<CallBase>(&inst);
+      Function *callee = call ? call->getCalledFunction() : nullptr;
+      if (!callee || callee->isDeclaration()) {
+        continue;
+      }
+      auto calleeSCC = state->recursiveSCCOf.find(callee);
+      if (scc != state->recursiveSCCOf.end() &&
+          calleeSCC != state->recursiveSCCOf.end() &&
+          calleeSCC->second == scc->second) {
+        ++recursiveCalls;
+        continue;
+      }
+      summary[{factors, callee->getName().str()}] += 1;
+    }
+  }
+
+  if (recursiveCalls && !recursionBounds.empty()) {
+    std::string depth = getCostBound(recursionBounds);
+    if (recursiveCalls > 1) {
+      depth = "exp2(" + depth + ")";
     }
+    CostSummary scaled;
+    for (auto it = summary.begin(); it != summary.end(); ++it) {
+      const std::string &factors = it->first.first;
+      scaled[{factors.empty() ? depth : depth + " * " + factors,
+              it->first.second}] = it->second;
+    }
+    summary = scaled;
+  }
+
+  costSummaries[F->getName().str()] = summary;
+}
+
+/**
+ * Marks every location a pointer may address as written by input.
+ *
+ * @param pointer A pointer handed to, or produced by, an input function.
+ * @param PTA The module-wide points-to analysis.
+ * @param locations The table of abstract locations.
+ */
+void markInputLocations(Value *pointer, SeminalPointsTo *PTA,
+                        LocationTable *locations) {
+  for (unsigned location : resolveLocations(pointer, PTA, locations)) {
+    locations->markInput(location);
+  }
+}
+
+/**
+ * Analyzes input-related functions across the module. The objects an input
+ * call writes are found through points-to classes, so input read through a
+ * pointer parameter or into a heap buffer taints the underlying object, and
+ * input into a struct field or array element taints only that location.
+ *
+ * @param module The module in which input-related functions are to be
+ * analyzed.
+ * @param PTA The module-wide points-to analysis.
+ * @param locations The table of locations to mark.
+ */
+void analyzeInputFunctions(Module *module, SeminalPointsTo *PTA,
+                           LocationTable *locations) {
+  // Search for input-related variables.
+  for (Function &function : *module) {
+    for (Instruction &instruction : instructions(function)) {
+
+      // CHECK: is this a call to a catalogued input source
+      CallInst *instPointer = dyn_cast<CallInst>(&instruction);
+      const SeminalLibraryModel *model =
+          SeminalLibraryCatalog::get().lookup(instPointer);
+      if (!model || !model->isSource()) {
+        continue;
+      }
+
+      for (const SeminalEndpoint &source : model->sources) {
+        if (source.kind == SeminalEndpoint::Ret) {
+          // The result is input, whether it stays in a register (SSA form)
+          // or is stored into a variable, possibly after a conversion
+          // (e.g. `char c = getc(f)`)
+          locations->markInput(locations->getRoot(instPointer));
+          std::vector<Value *> results = {instPointer};
+          for (User *user : instPointer->users()) {
+            if (isa<CastInst>(user)) {
+              results.push_back(user);
+            }
+          }
+          for (Value *result : results) {
+            for (User *user : result->users()) {
+              StoreInst *storeInst = dyn_cast<StoreInst>(user);
+              if (storeInst && storeInst->getValueOperand() == result) {
+                markInputLocations(storeInst->getPointerOperand(), PTA,
+                                   locations);
+              }
+            }
+          }
+          continue;
+        }
+
+        // Input is written to the memory behind the argument(s)
+        for (Value *argument : source.getArguments(instPointer)) {
+          if (argument->getType()->isPointerTy()) {
+            markInputLocations(stripArrayDecay(argument), PTA, locations);
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Builds the table describing every named memory object of the module in one
+ * scan: locals through their dbg.declare, globals through their
+ * DIGlobalVariable, and heap sites after the variable their address is
+ * stored into (or the allocator and line when it is not stored).
+ *
+ * @param module The module to scan.
+ * @param objects The table to fill.
+ */
+void buildObjectTable(Module *module,
+                      DenseMap<const Value *, ObjectInfo> *objects) {
+  for (GlobalVariable &global : module->globals()) {
+    SmallVector<DIGlobalVariableExpression *, 1> expressions;
+    global.getDebugInfo(expressions);
+    for (DIGlobalVariableExpression *expression : expressions) {
+      DIGlobalVariable *variable = expression->getVariable();
+      if (variable) {
+        (*objects)[&global] = {variable->getName().str(),
+                               int(variable->getLine()), variable->getType()};
+        break;
+      }
+    }
+  }
+
+  std::vector<CallBase *> heapSites;
+  DenseMap<const Value *, ObjectInfo> heapHolders;
+  for (Function &function : *module) {
+    for (Instruction &instruction : instructions(function)) {
+      if (DbgDeclareInst *dbgDeclare = dyn_cast<DbgDeclareInst>(&instruction)) {
+        DILocalVariable *variable = dbgDeclare->getVariable();
+        Value *address = dbgDeclare->getAddress();
+        if (variable && address && isa<AllocaInst>(address)) {
+          (*objects)[address] = {variable->getName().str(),
+                                 int(dbgDeclare->getDebugLoc().getLine()),
+                                 variable->getType()};
+        }
+      } else if (DbgValueInst *dbgValue =
+                     dyn_cast<DbgValueInst>(&instruction)) {
+        // In SSA form a variable is a value: an input call's result, or a
+        // heap pointer that was never stored to an alloca
+        DILocalVariable *variable = dbgValue->getVariable();
+        Value *value = dbgValue->getValue();
+        CallBase *call =
+            value ? dyn_cast<CallBase>(stripIntCasts(value)) : nullptr;
+        if (!variable || !call) {
+          continue;
+        }
+
+        ObjectInfo info = {variable->getName().str(),
+                           int(variable->getLine()), variable->getType()};
+        const SeminalLibraryModel *model =
+            SeminalLibraryCatalog::get().lookup(call);
+        if (SeminalPointsTo::isHeapAllocation(call)) {
+          heapHolders.try_emplace(call, info);
+        } else if (model && model->isSource()) {
+          objects->try_emplace(call, info);
+        }
+      } else if (SeminalPointsTo::isHeapAllocation(&instruction)) {
+        heapSites.push_back(cast<CallBase>(&instruction));
+      }
+    }
+  }
+
+  // Heap sites are named after the pointer variable their address is stored
+  // into, when that variable is declared
+  for (CallBase *site : heapSites) {
+    int line = site->getDebugLoc() ? int(site->getDebugLoc().getLine()) : -1;
+    ObjectInfo info = {site->getCalledFunction()->getName().str() + "@" +
+                           std::to_string(line),
+                       line, nullptr};
+    std::vector<Value *> addresses = {site};
+    for (User *user : site->users()) {
+      if (isa<CastInst>(user)) {
+        addresses.push_back(user);
+      }
+    }
+
+    // A pointer kept in a register is described by its dbg.value
+    auto holder = heapHolders.find(site);
+    if (holder != heapHolders.end()) {
+      addresses.clear();
+      info.name = "*" + holder->second.name;
+      DIDerivedType *pointerType = dyn_cast_or_null<DIDerivedType>(
+          stripDebugQualifiers(holder->second.type));
+      if (pointerType &&
+          pointerType->getTag() == dwarf::DW_TAG_pointer_type) {
+        info.type = pointerType->getBaseType();
+      }
+    }
+
+    for (Value *address : addresses) {
+      StoreInst *store = nullptr;
+      for (User *user : address->users()) {
+        StoreInst *candidate = dyn_cast<StoreInst>(user);
+        if (candidate && candidate->getValueOperand() == address &&
+            objects->count(candidate->getPointerOperand())) {
+          store = candidate;
+          break;
+        }
+      }
+      if (!store) {
+        continue;
+      }
+
+      const ObjectInfo &holder = (*objects)[store->getPointerOperand()];
+      info.name = "*" + holder.name;
+      DIDerivedType *pointerType =
+          dyn_cast_or_null<DIDerivedType>(stripDebugQualifiers(holder.type));
+      if (pointerType && pointerType->getTag() == dwarf::DW_TAG_pointer_type) {
+        info.type = pointerType->getBaseType();
+      }
+      break;
+    }
+    (*objects)[site] = info;
+  }
+}
+
+/**
+ * Finds the recursive functions of a module with a single traversal of the
+ * strongly connected components of its call graph, in linear time. A
+ * component is recursive if it has more than one function or a function
+ * calling itself.
+ *
+ * @param module The module to scan.
+ * @param state The module state receiving the recursive components.
+ */
+void findRecursiveSCCs(Module *module, ModuleState *state) {
+  CallGraph callGraph(*module);
+  for (auto scc = scc_begin(&callGraph); !scc.isAtEnd(); ++scc) {
+    if (!scc.hasCycle()) {
+      continue;
+    }
+
+    std::vector<Function *> functions;
+    for (CallGraphNode *node : *scc) {
+      Function *function = node->getFunction();
+      if (function && !function->isDeclaration()) {
+        state->recursiveSCCOf[function] = state->recursiveSCCs.size();
+        functions.push_back(function);
+      }
+    }
+    if (!functions.empty()) {
+      state->recursiveSCCs.push_back(functions);
+    }
+  }
+}
+
+/**
+ * Returns the source name of a parameter, from the debug variable that
+ * describes it (clang drops IR value names in release builds).
+ *
+ * @param arg The parameter to name.
+ */
+std::string getParameterName(Argument *arg) {
+  for (Instruction &inst : instructions(*arg->getParent())) {
+    DbgVariableIntrinsic *dbg = dyn_cast<DbgVariableIntrinsic>(&inst);
+    if (dbg && dbg->getVariable() &&
+        dbg->getVariable()->getArg() == arg->getArgNo() + 1) {
+      return dbg->getVariable()->getName().str();
+    }
+  }
+  return arg->hasName() ? arg->getName().str()
+                        : "arg" + std::to_string(arg->getArgNo());
+}
+
+/**
+ * Builds the module-wide state: the points-to analysis, the object table,
+ * the recursive functions and the input locations.
+ *
+ * @param M The module being analyzed.
+ * @param state The state to fill.
+ */
+void buildModuleState(Module *M, ModuleState *state) {
+  state->M = M;
+  state->PTA = std::make_unique<SeminalPointsTo>(*M);
+  buildObjectTable(M, &state->objects);
+  findRecursiveSCCs(M, state);
+  analyzeInputFunctions(M, state->PTA.get(), &state->locations);
+}
+
+/**
+ * Pairs input variables with termination variables and prints or processes
+ * them.
+ *
+ * @param variableMap A map containing variable names and their information.
+ * @param implicitMap Variables that reach a sink only through control
+ * dependence; reported separately from the direct ones.
+ * @param details Further per-function results (allocations, recursion),
+ * reported along with the variables.
+ * @param locations The table of locations, marked where input writes them.
+ * @param F The function being analyzed (used to get the function name).
+ */
+void pairInputTerminal(std::unordered_map<std::string, VarInfo> *variableMap,
+                       std::unordered_map<std::string, VarInfo> *implicitMap,
+                       const Json &details, LocationTable *locations,
+                       Function *F) {
+  // Create JSON for the variables
+  Json functionJson;
+  functionJson["function"] =
+      F->getName().str(); // Use F.getName() to get the function name
+  if (DISubprogram *subprogram = F->getSubprogram()) {
+    functionJson["file"] = subprogram->getFilename().str();
+  }
+  Json variablesJson = createVariablesJson(variableMap, locations);
+
+  // A variable that also flows directly is only reported as direct
+  for (auto it = variableMap->begin(); it != variableMap->end(); ++it) {
+    implicitMap->erase(it->first);
+  }
+  Json implicitJson = createVariablesJson(implicitMap, locations);
+
+  if (!variablesJson.empty() || !implicitJson.empty() ||
+      details.contains("allocations")) {
+    functionJson["important_variables"] = variablesJson;
+    if (!implicitJson.empty()) {
+      functionJson["implicit_variables"] = implicitJson;
+    }
+    functionJson.update(details);
+    importantVar.push_back(
+        functionJson); // Assuming importantVar is defined elsewhere
   }
 }
 
@@ -591,42 +2608,169 @@ void handleFunctionVariables(
  *
  * @param function The function to analyze.
  * @param loopInfo The loop information used in the analysis.
+ * @param MSSA The MemorySSA used to resolve loads to their defining stores.
+ * @param CD The control dependences of the function.
+ * @param SE The ScalarEvolution used to express allocation sizes.
+ * @param TTI The target's instruction costs, if a cost oracle is written.
+ * @param state The module-wide state of the function's module.
  */
-void analyze(Function *function, LoopInfo *loopInfo) {
-  std::unordered_set<std::string> ioVar;
+void analyze(Function *function, LoopInfo *loopInfo, MemorySSA *MSSA,
+             const SeminalControlDependence *CD, ScalarEvolution *SE,
+             TargetTransformInfo *TTI, ModuleState *state) {
   std::set<Value *> seenValues;
   std::unordered_map<std::string, VarInfo> VarInfoMap;
+  std::unordered_map<std::string, VarInfo> ImplicitInfoMap;
+
+  DefUseContext ctx = {function, MSSA, state};
+
+  // Locate the decision points of the function (loop exits, switches,
+  // selects, indirect calls); each is traced back only through the defs
+  // MemorySSA links it to
+  std::vector<Sink> sinks = collectSinks(function, loopInfo, CD, state);
+  std::set<Argument *> recursionParameters;
+  std::map<Loop *, std::set<std::string>> loopBounds;
+  std::set<std::string> recursionBounds;
+  std::set<Instruction *> inputDecisions;
+  processSinks(sinks, loopInfo, &seenValues, &VarInfoMap, &ctx,
+               &recursionParameters, &loopBounds, &recursionBounds,
+               &inputDecisions);
+
+  Json details = summarizeDecisions(function, sinks, inputDecisions, CD);
+  Json allocationsJson = processAllocations(sinks, SE, &seenValues, &ctx);
+  if (!allocationsJson.empty()) {
+    details["allocations"] = allocationsJson;
+  }
 
-  // Locate loops in the given function
-  processLoops(loopInfo, &seenValues, &VarInfoMap, function);
+  // The recursion this function takes part in, and what terminates it
+  auto scc = state->recursiveSCCOf.find(function);
+  if (scc != state->recursiveSCCOf.end()) {
+    Json recursionJson;
+    recursionJson["functions"] = Json::array();
+    for (Function *member : state->recursiveSCCs[scc->second]) {
+      recursionJson["functions"].push_back(member->getName().str());
+    }
+    recursionJson["parameters"] = Json::array();
+    for (Argument *arg : recursionParameters) {
+      recursionJson["parameters"].push_back(getParameterName(arg));
+    }
+    details["recursion"] = recursionJson;
+  }
 
-  // Find source of all function variables
-  handleFunctionVariables(function, &VarInfoMap, &seenValues);
+  // How the running time grows with the input; written once callees are known
+  Json loopsJson = summarizeComplexity(function, loopInfo, SE, loopBounds,
+                                       recursionBounds, &ctx);
+  if (!loopsJson.empty()) {
+    details["loops"] = loopsJson;
+  }
+  if (TTI) {
+    summarizeCost(function, loopInfo, SE, TTI, loopBounds, recursionBounds,
+                  state);
+  }
 
-  // Search for input-related variables.
-  analyzeInputFunctions(function, &VarInfoMap, &ioVar);
+  // Conditions deciding whether those sinks and definitions execute
+  if (ImplicitFlows) {
+    processImplicitFlows(sinks, CD, seenValues, &ImplicitInfoMap, &ctx);
+  }
 
   // Pair input variable with termination variable and get the variable line
   // number and name
-  pairInputTerminal(&VarInfoMap, &ioVar, function);
+  pairInputTerminal(&VarInfoMap, &ImplicitInfoMap, details,
+                    &state->locations, function);
 }
 
 // ---- END CLIENT FUNCTION ----
 
 // ---- PASS DEFINITION ----
 
+AnalysisKey SeminalControlDependenceAnalysis::Key;
+
+ArrayRef<Instruction *>
+SeminalControlDependence::getControllingTerminators(const BasicBlock *BB) const {
+  auto it = dependences.find(BB);
+  if (it == dependences.end()) {
+    return {};
+  }
+  return it->second;
+}
+
+void SeminalControlDependence::addDependence(const BasicBlock *BB,
+                                             Instruction *Terminator) {
+  SmallVector<Instruction *, 2> &terminators = dependences[BB];
+  if (!is_contained(terminators, Terminator)) {
+    terminators.push_back(Terminator);
+  }
+}
+
 /**
- * Executes the Seminal Input Detector pass on a given function.
+ * Computes the control dependences of a function. For each edge A->S where S
+ * does not post-dominate A, the blocks from S up the post-dominator tree to
+ * (excluding) the immediate post-dominator of A are control dependent on A.
  *
  * @param F The function to analyze.
- * @param FAM The function analysis manager providing loop analysis results.
- * @return The preserved analyses after the pass runs.
+ * @param FAM The function analysis manager providing the post-dominator tree.
+ * @return The control dependences of F.
  */
-PreservedAnalyses SeminalInputDetectorPass::run(Function &F,
-                                                FunctionAnalysisManager &FAM) {
+SeminalControlDependence
+SeminalControlDependenceAnalysis::run(Function &F,
+                                      FunctionAnalysisManager &FAM) {
+  PostDominatorTree &PDT = FAM.getResult<PostDominatorTreeAnalysis>(F);
+  SeminalControlDependence result;
+
+  for (BasicBlock &A : F) {
+    Instruction *terminator = A.getTerminator();
+    if (!terminator || terminator->getNumSuccessors() < 2) {
+      continue;
+    }
 
-  LoopInfo &LI = FAM.getResult<LoopAnalysis>(F);
-  analyze(&F, &LI);
+    DomTreeNode *nodeA = PDT.getNode(&A);
+    DomTreeNode *stop = nodeA ? nodeA->getIDom() : nullptr;
+
+    for (BasicBlock *S : successors(&A)) {
+      for (DomTreeNode *runner = PDT.getNode(S); runner && runner != stop;
+           runner = runner->getIDom()) {
+        if (runner->getBlock()) {
+          result.addDependence(runner->getBlock(), terminator);
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+/**
+ * Executes the Seminal Input Detector pass on every function of a module.
+ * Input-related variables are found once per module, through points-to; that
+ * state lives only as long as this run, so a process handling several
+ * modules never sees another module's locations.
+ *
+ * @param M The module to analyze.
+ * @param MAM The module analysis manager, whose function analysis manager
+ * provides loop, MemorySSA, control-dependence, ScalarEvolution and target
+ * cost results.
+ * @return The preserved analyses after the pass runs.
+ */
+PreservedAnalyses SeminalInputDetectorPass::run(Module &M,
+                                                ModuleAnalysisManager &MAM) {
+  FunctionAnalysisManager &FAM =
+      MAM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  ModuleState state;
+  buildModuleState(&M, &state);
+  detectorRan = true;
+
+  for (Function &F : M) {
+    if (F.isDeclaration()) {
+      continue;
+    }
+    LoopInfo &LI = FAM.getResult<LoopAnalysis>(F);
+    MemorySSA &MSSA = FAM.getResult<MemorySSAAnalysis>(F).getMSSA();
+    SeminalControlDependence &CD =
+        FAM.getResult<SeminalControlDependenceAnalysis>(F);
+    ScalarEvolution &SE = FAM.getResult<ScalarEvolutionAnalysis>(F);
+    TargetTransformInfo *TTI =
+        CostOracle.empty() ? nullptr : &FAM.getResult<TargetIRAnalysis>(F);
+    analyze(&F, &LI, &MSSA, &CD, &SE, TTI, &state);
+  }
   return PreservedAnalyses::all();
 }
 // ---- END PASS DEFINITION ----
@@ -0,0 +1,1026 @@
+/**
+ * Seminal feature snapshot instrumentation.
+ *
+ * @file SeminalInstrumenter.cpp
+ * @brief Reads the seminal features reported by the Seminal Input Detector
+ * and instruments the program to record their actual values at run time. In
+ * each function that reads a feature, the dominator tree gives the earliest
+ * point at which every read has happened (reads inside a loop complete at
+ * the loop's exit); there the values, and the lengths of input streams and
+ * buffers, are handed to the snapshot runtime, which publishes them to a side
+ * file or shared memory. A supervisor can then predict the job's cost a few
+ * milliseconds after it starts.
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#include "llvm/Transforms/Utils/SeminalInstrumenter.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/BinaryFormat/Dwarf.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/SeminalInputDetector.h"
+#include "llvm/Transforms/Utils/SeminalLibraryCatalog.h"
+
+#include "nlohmann/json.hpp"
+
+using namespace llvm;
+
+using Json = nlohmann::json;
+
+static cl::opt<std::string> FeaturesFile(
+    "seminal-features", cl::init("seminal-values.json"),
+    cl::value_desc("file"),
+    cl::desc("The Seminal Input Detector output naming the features to "
+             "snapshot"));
+
+static cl::opt<std::string> SnapshotTarget(
+    "seminal-snapshot-path", cl::init("seminal-snapshot.txt"),
+    cl::value_desc("path"),
+    cl::desc("Where the instrumented program writes its feature snapshot: "
+             "a file, or a shared memory name with -seminal-snapshot-shm"));
+
+static cl::opt<bool> SnapshotShared(
+    "seminal-snapshot-shm", cl::init(false),
+    cl::desc("Publish the feature snapshot in POSIX shared memory instead "
+             "of a file"));
+
+static cl::opt<bool> WrapInput(
+    "seminal-wrap-input", cl::init(false),
+    cl::desc("Redirect scanf, fscanf and sscanf to runtime wrappers that log "
+             "the values they parse"));
+
+static cl::opt<std::string> InputLog(
+    "seminal-input-log", cl::init("seminal-inputs.bin"),
+    cl::value_desc("file"),
+    cl::desc("Where the input wrappers write the binary log of parsed "
+             "values"));
+
+static cl::opt<bool> CountInput(
+    "seminal-count-input", cl::init(false),
+    cl::desc("Redirect stream reads (getc, fgets, fread, getline, read, ...) "
+             "to runtime wrappers that count bytes, calls and time per "
+             "stream"));
+
+static cl::opt<std::string> InputSummary(
+    "seminal-io-summary", cl::init("seminal-io.txt"), cl::value_desc("file"),
+    cl::desc("Where the stream read wrappers write one summary line per "
+             "stream at exit"));
+
+static cl::opt<bool> TrackBuffers(
+    "seminal-track-buffers", cl::init(false),
+    cl::desc("Keep the highest index written to each buffer length feature, "
+             "per store, and snapshot it at exit"));
+
+static cl::opt<std::string> DatasetFile(
+    "seminal-dataset", cl::init(""), cl::value_desc("file"),
+    cl::desc("Count loop iterations and branch directions, and append one "
+             "fixed-size record per run to this dataset; its columns are "
+             "written to <file>.schema"));
+
+namespace {
+
+/** A seminal feature to snapshot, and where the program keeps it. */
+struct SnapshotFeature {
+  /** The name reported by the detector, e.g. `game.board[1][2]`. */
+  std::string name;
+
+  /** The declaration line of the variable. */
+  unsigned line;
+
+  /** True if the feature is the length of a stream or buffer. */
+  bool length;
+
+  /** The alloca or global holding the variable. */
+  Value *storage;
+
+  /** The byte offset of the feature within the storage. */
+  uint64_t offset;
+
+  /** The declared type of the feature itself. */
+  DIType *type;
+};
+
+} // namespace
+
+// ---- HELPER FUNCTIONS ----
+
+/**
+ * Returns true if a debug type is the C library's `FILE`.
+ *
+ * @param type The pointee type of a pointer.
+ */
+static bool isFileType(DIType *type) {
+  while (DIDerivedType *derived = dyn_cast_or_null<DIDerivedType>(type)) {
+    if (derived->getName() == "FILE") {
+      return true;
+    }
+    type = derived->getBaseType();
+  }
+  return type && type->getName() == "_IO_FILE";
+}
+
+/**
+ * Follows the field and element steps of a reported name (`.guesses_left`,
+ * `[1][2]`) through the debug type of the variable.
+ *
+ * @param type The declared type of the variable.
+ * @param path The part of the name after the variable, e.g. `.board[1][2]`.
+ * @param offset Receives the byte offset of the feature.
+ * @param result Receives the type of the feature.
+ * @return False if a step does not match the type.
+ */
+static bool resolvePath(DIType *type, StringRef path, uint64_t *offset,
+                        DIType **result) {
+  *offset = 0;
+  DICompositeType *array = nullptr;
+  unsigned dimension = 0;
+  uint64_t stride = 0;
+
+  while (!path.empty()) {
+    if (path.consume_front("[")) {
+      if (!array) {
+        array = dyn_cast_or_null<DICompositeType>(stripDebugQualifiers(type));
+        if (!array || array->getTag() != dwarf::DW_TAG_array_type) {
+          return false;
+        }
+        dimension = 0;
+        stride = array->getSizeInBits() / 8;
+      }
+
+      DINodeArray ranges = array->getElements();
+      DISubrange *range = dimension < ranges.size()
+                              ? dyn_cast<DISubrange>(ranges[dimension])
+                              : nullptr;
+      ConstantInt *count =
+          range ? range->getCount().dyn_cast<ConstantInt *>() : nullptr;
+      uint64_t index = 0;
+      if (!count || count->isZero() || path.consumeInteger(10, index) ||
+          !path.consume_front("]")) {
+        return false;
+      }
+      stride /= count->getZExtValue();
+      *offset += index * stride;
+
+      if (++dimension == ranges.size()) {
+        type = array->getBaseType();
+        array = nullptr;
+      }
+    } else if (path.consume_front(".")) {
+      DICompositeType *record =
+          dyn_cast_or_null<DICompositeType>(stripDebugQualifiers(type));
+      if (array || !record) {
+        return false;
+      }
+      StringRef field = path.take_until([](char c) {
+        return c == '.' || c == '[';
+      });
+      path = path.drop_front(field.size());
+
+      DIDerivedType *found = nullptr;
+      for (DINode *element : record->getElements()) {
+        DIDerivedType *member = dyn_cast<DIDerivedType>(element);
+        if (member && member->getTag() == dwarf::DW_TAG_member &&
+            member->getName() == field) {
+          found = member;
+        }
+      }
+      if (!found) {
+        return false;
+      }
+      *offset += found->getOffsetInBits() / 8;
+      type = found->getBaseType();
+    } else {
+      return false;
+    }
+  }
+
+  *result = type;
+  return !array;
+}
+
+/**
+ * Finds the storage of a reported variable: the global or the alloca whose
+ * debug variable has the name and declaration line.
+ *
+ * @param M The module to search.
+ * @param name The variable's name, without field or element steps.
+ * @param line The variable's declaration line; 0 matches any line.
+ * @param type Receives the declared type of the variable.
+ * @return The storage, or null if the variable is not in memory.
+ */
+static Value *findStorage(Module &M, StringRef name, unsigned line,
+                          DIType **type) {
+  for (GlobalVariable &global : M.globals()) {
+    SmallVector<DIGlobalVariableExpression *, 1> expressions;
+    global.getDebugInfo(expressions);
+    for (DIGlobalVariableExpression *expression : expressions) {
+      DIGlobalVariable *variable = expression->getVariable();
+      if (variable->getName() == name &&
+          (!line || variable->getLine() == line)) {
+        *type = variable->getType();
+        return &global;
+      }
+    }
+  }
+
+  for (Function &F : M) {
+    for (Instruction &inst : instructions(F)) {
+      DbgDeclareInst *declare = dyn_cast<DbgDeclareInst>(&inst);
+      if (declare && declare->getVariable()->getName() == name &&
+          (!line || declare->getVariable()->getLine() == line) &&
+          isa<AllocaInst>(declare->getAddress())) {
+        *type = declare->getVariable()->getType();
+        return declare->getAddress();
+      }
+    }
+  }
+  return nullptr;
+}
+
+Value *llvm::findFeatureStorage(Module &M, StringRef Name, unsigned Line,
+                                uint64_t *Offset, DIType **Type) {
+  size_t split = Name.find_first_of(".[");
+  DIType *declared = nullptr;
+  Value *storage = findStorage(M, Name.substr(0, split), Line, &declared);
+  if (!storage || !resolvePath(declared,
+                               split == StringRef::npos ? StringRef()
+                                                        : Name.substr(split),
+                               Offset, Type)) {
+    return nullptr;
+  }
+  return storage;
+}
+
+/**
+ * Returns true if a call may write the memory its argument points to: a
+ * library function whose catalog model writes it, an unknown library
+ * function, or a function defined in the module.
+ *
+ * @param call The call.
+ * @param argNo The argument holding the pointer.
+ */
+static bool writesArgument(CallBase *call, unsigned argNo) {
+  const SeminalLibraryModel *model = SeminalLibraryCatalog::get().lookup(call);
+  if (!model) {
+    return !isa<IntrinsicInst>(call);
+  }
+  return model->writesArgument(argNo);
+}
+
+/**
+ * Collects the instructions that may write a variable with a value that is
+ * not a constant: stores of computed values, and calls handed its address.
+ *
+ * @param M The module to scan.
+ * @param storage The variable's alloca or global.
+ * @param reads Receives the writing instructions.
+ */
+static void collectReads(Module &M, Value *storage,
+                         std::vector<Instruction *> *reads) {
+  for (Function &F : M) {
+    if (isa<AllocaInst>(storage) &&
+        cast<AllocaInst>(storage)->getFunction() != &F) {
+      continue;
+    }
+    for (Instruction &inst : instructions(F)) {
+      if (StoreInst *store = dyn_cast<StoreInst>(&inst)) {
+        if (getUnderlyingObject(store->getPointerOperand()) == storage &&
+            !isa<Constant>(store->getValueOperand())) {
+          reads->push_back(store);
+        }
+      } else if (CallBase *call = dyn_cast<CallBase>(&inst)) {
+        for (unsigned i = 0; i < call->arg_size(); ++i) {
+          Value *arg = call->getArgOperand(i);
+          if (arg->getType()->isPointerTy() &&
+              getUnderlyingObject(arg) == storage &&
+              writesArgument(call, i)) {
+            reads->push_back(call);
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
+Instruction *llvm::getCompletionPoint(Instruction *Inst, LoopInfo &LI,
+                                      PostDominatorTree &PDT) {
+  Loop *loop = LI.getLoopFor(Inst->getParent());
+  if (!loop) {
+    if (InvokeInst *invoke = dyn_cast<InvokeInst>(Inst)) {
+      return &*invoke->getNormalDest()->getFirstInsertionPt();
+    }
+    return Inst->getNextNode();
+  }
+
+  while (loop->getParentLoop()) {
+    loop = loop->getParentLoop();
+  }
+  SmallVector<BasicBlock *, 4> exits;
+  loop->getUniqueExitBlocks(exits);
+  BasicBlock *exit = nullptr;
+  for (BasicBlock *block : exits) {
+    exit = exit ? PDT.findNearestCommonDominator(exit, block) : block;
+    if (!exit) {
+      return nullptr;
+    }
+  }
+  return exit ? &*exit->getFirstInsertionPt() : nullptr;
+}
+
+Instruction *llvm::findLatestPoint(ArrayRef<Instruction *> Points,
+                                   DominatorTree &DT, PostDominatorTree &PDT) {
+  for (Instruction *point : Points) {
+    bool dominated = true;
+    for (Instruction *other : Points) {
+      dominated &= other == point || DT.dominates(other, point);
+    }
+    if (dominated) {
+      return point;
+    }
+  }
+
+  BasicBlock *join = nullptr;
+  for (Instruction *point : Points) {
+    join = join ? PDT.findNearestCommonDominator(join, point->getParent())
+                : point->getParent();
+    if (!join) {
+      return nullptr;
+    }
+  }
+
+  // A point in the join block itself comes after the block's start
+  Instruction *latest = nullptr;
+  for (Instruction *point : Points) {
+    if (point->getParent() == join &&
+        (!latest || latest->comesBefore(point))) {
+      latest = point;
+    }
+  }
+  return latest ? latest : &*join->getFirstInsertionPt();
+}
+
+/**
+ * Finds the earliest point at which all reads of a function have completed.
+ *
+ * @param reads The reading instructions of one function.
+ * @param DT The dominator tree of the function.
+ * @param PDT The post-dominator tree of the function.
+ * @param LI The LoopInfo of the function.
+ * @return The instruction to insert the snapshot before, or null.
+ */
+static Instruction *findSnapshotPoint(const std::vector<Instruction *> &reads,
+                                      DominatorTree &DT,
+                                      PostDominatorTree &PDT, LoopInfo &LI) {
+  std::vector<Instruction *> points;
+  for (Instruction *read : reads) {
+    Instruction *point = getCompletionPoint(read, LI, PDT);
+    if (!point) {
+      return nullptr;
+    }
+    points.push_back(point);
+  }
+  return points.empty() ? nullptr : findLatestPoint(points, DT, PDT);
+}
+
+/**
+ * Reads the seminal features of the detector's output, dropping duplicates
+ * and collapsed (`[*]`) locations, which have no single address.
+ *
+ * @param path The detector's JSON output.
+ * @param features Receives the features.
+ * @return False if the file cannot be read.
+ */
+static bool readFeatures(const std::string &path,
+                         std::vector<SnapshotFeature> *features) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  Json output = Json::parse(file, nullptr, false);
+  if (!output.is_array()) {
+    return false;
+  }
+
+  std::set<std::pair<std::string, unsigned>> seen;
+  for (const Json &functionJson : output) {
+    if (!functionJson.contains("important_variables")) {
+      continue;
+    }
+    for (const Json &variable : functionJson["important_variables"]) {
+      SnapshotFeature feature;
+      feature.name = variable.value("name", "");
+      feature.line = variable.value("line", 0u);
+      feature.length = variable.value("feature", "") == "length";
+      feature.storage = nullptr;
+      feature.offset = 0;
+      feature.type = nullptr;
+      if (feature.name.find("[*]") == std::string::npos &&
+          seen.insert({feature.name, feature.line}).second) {
+        features->push_back(feature);
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Inserts the call recording one feature: its value for a scalar, the size
+ * of the file behind a `FILE *`, or the length of a string buffer.
+ *
+ * @param builder The builder positioned at the snapshot point.
+ * @param feature The feature to record.
+ * @return False if the feature's type cannot be recorded.
+ */
+static bool insertRecord(IRBuilder<> &builder, const SnapshotFeature &feature) {
+  Module *M = builder.GetInsertBlock()->getModule();
+  LLVMContext &Ctx = M->getContext();
+  Type *VoidTy = builder.getVoidTy();
+  Type *Int8PtrTy = builder.getInt8PtrTy();
+  DIType *type = stripDebugQualifiers(feature.type);
+  if (!type) {
+    return false;
+  }
+
+  std::string label =
+      feature.length ? "len(" + feature.name + ")" : feature.name;
+  Value *address = builder.CreatePointerCast(feature.storage, Int8PtrTy);
+  if (feature.offset) {
+    address = builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(), address,
+                                                 feature.offset);
+  }
+
+  if (DICompositeType *composite = dyn_cast<DICompositeType>(type)) {
+    if (composite->getTag() == dwarf::DW_TAG_array_type) {
+      FunctionCallee recordBuffer = M->getOrInsertFunction(
+          "__seminal_record_buffer",
+          FunctionType::get(VoidTy, {Int8PtrTy, Int8PtrTy, builder.getInt64Ty()},
+                            false));
+      builder.CreateCall(recordBuffer,
+                         {builder.CreateGlobalStringPtr(label), address,
+                          builder.getInt64(composite->getSizeInBits() / 8)});
+      return true;
+    }
+    if (composite->getTag() != dwarf::DW_TAG_enumeration_type) {
+      return false;
+    }
+  }
+
+  if (DIDerivedType *pointer = dyn_cast<DIDerivedType>(type)) {
+    if (pointer->getTag() != dwarf::DW_TAG_pointer_type ||
+        !pointer->getBaseType()) {
+      return false;
+    }
+    Value *target = builder.CreateLoad(
+        Int8PtrTy, builder.CreatePointerCast(
+                       address, PointerType::getUnqual(Int8PtrTy)));
+    if (isFileType(pointer->getBaseType())) {
+      FunctionCallee recordStream = M->getOrInsertFunction(
+          "__seminal_record_stream",
+          FunctionType::get(VoidTy, {Int8PtrTy, Int8PtrTy}, false));
+      builder.CreateCall(recordStream,
+                         {builder.CreateGlobalStringPtr(label), target});
+      return true;
+    }
+    FunctionCallee recordBuffer = M->getOrInsertFunction(
+        "__seminal_record_buffer",
+        FunctionType::get(VoidTy, {Int8PtrTy, Int8PtrTy, builder.getInt64Ty()},
+                          false));
+    builder.CreateCall(recordBuffer, {builder.CreateGlobalStringPtr(label),
+                                      target, builder.getInt64(0)});
+    return true;
+  }
+
+  // Scalars: integers, enumerations, booleans and floating point
+  uint64_t bits = type->getSizeInBits();
+  DIBasicType *basic = dyn_cast<DIBasicType>(type);
+  bool isFloat = basic && basic->getEncoding() == dwarf::DW_ATE_float;
+  bool isUnsigned = basic && (basic->getEncoding() == dwarf::DW_ATE_unsigned ||
+                              basic->getEncoding() ==
+                                  dwarf::DW_ATE_unsigned_char ||
+                              basic->getEncoding() == dwarf::DW_ATE_boolean);
+  Type *loadTy = nullptr;
+  if (isFloat) {
+    loadTy = bits == 32   ? builder.getFloatTy()
+             : bits == 64 ? builder.getDoubleTy()
+                          : nullptr;
+  } else if (bits && bits <= 64) {
+    loadTy = Type::getIntNTy(Ctx, bits);
+  }
+  if (!loadTy) {
+    return false;
+  }
+
+  Value *value = builder.CreateLoad(
+      loadTy,
+      builder.CreatePointerCast(address, PointerType::getUnqual(loadTy)));
+  Type *DoubleTy = builder.getDoubleTy();
+  if (isFloat) {
+    value = builder.CreateFPCast(value, DoubleTy);
+  } else if (isUnsigned) {
+    value = builder.CreateUIToFP(value, DoubleTy);
+  } else {
+    value = builder.CreateSIToFP(value, DoubleTy);
+  }
+
+  FunctionCallee recordValue = M->getOrInsertFunction(
+      "__seminal_record_value",
+      FunctionType::get(VoidTy, {Int8PtrTy, DoubleTy}, false));
+  builder.CreateCall(recordValue, {builder.CreateGlobalStringPtr(label), value});
+  return true;
+}
+
+/**
+ * Redirects every call to scanf, fscanf and sscanf to its runtime wrapper
+ * (`__seminal_scanf`, ...), which takes a call site ID and the call's source
+ * location ahead of the original arguments. Calls with a constant format come
+ * first, so the runtime can parse their format once; the others, whose format
+ * may change between calls, get the IDs after them.
+ *
+ * @param M The module to instrument.
+ * @param cachedSites Set to the number of calls with a constant format.
+ * @return The number of call sites wrapped.
+ */
+static unsigned wrapInputCalls(Module &M, unsigned *cachedSites) {
+  std::vector<CallInst *> calls;
+  for (Function &F : M) {
+    for (Instruction &inst : instructions(F)) {
+      CallInst *call = dyn_cast<CallInst>(&inst);
+      Function *callee = call ? call->getCalledFunction() : nullptr;
+      if (!callee || !callee->isDeclaration()) {
+        continue;
+      }
+      StringRef name = SeminalLibraryCatalog::normalizeName(callee->getName());
+      if (name == "scanf" || name == "fscanf" || name == "sscanf") {
+        calls.push_back(call);
+      }
+    }
+  }
+
+  auto hasConstantFormat = [](CallInst *call) {
+    StringRef name = SeminalLibraryCatalog::normalizeName(
+        call->getCalledFunction()->getName());
+    unsigned index = name == "scanf" ? 0 : 1;
+    StringRef format;
+    return index < call->arg_size() &&
+           getConstantStringInfo(call->getArgOperand(index), format);
+  };
+  *cachedSites =
+      std::stable_partition(calls.begin(), calls.end(), hasConstantFormat) -
+      calls.begin();
+
+  unsigned site = 0;
+  for (CallInst *call : calls) {
+    Function *callee = call->getCalledFunction();
+    FunctionType *type = callee->getFunctionType();
+    IRBuilder<> builder(call);
+
+    std::vector<Type *> params = {builder.getInt32Ty(),
+                                  builder.getInt8PtrTy()};
+    params.insert(params.end(), type->param_begin(), type->param_end());
+    FunctionCallee wrapper = M.getOrInsertFunction(
+        ("__seminal_" + SeminalLibraryCatalog::normalizeName(
+                            callee->getName()))
+            .str(),
+        FunctionType::get(type->getReturnType(), params, true));
+
+    std::string location = call->getFunction()->getName().str();
+    if (const DebugLoc &loc = call->getDebugLoc()) {
+      location += ":" + std::to_string(loc.getLine());
+    }
+    std::vector<Value *> args = {builder.getInt32(site++),
+                                 builder.CreateGlobalStringPtr(location)};
+    args.insert(args.end(), call->arg_begin(), call->arg_end());
+
+    CallInst *wrapped = builder.CreateCall(wrapper, args);
+    wrapped->setDebugLoc(call->getDebugLoc());
+    wrapped->takeName(call);
+    call->replaceAllUsesWith(wrapped);
+    call->eraseFromParent();
+  }
+  return site;
+}
+
+/**
+ * Redirects every call to an input source of the library catalog that reads
+ * a stream or file descriptor to its runtime wrapper (`__seminal_getc`, ...),
+ * which has the same signature.
+ *
+ * @param M The module to instrument.
+ * @return The number of calls redirected.
+ */
+static unsigned wrapStreamReads(Module &M) {
+  static const StringRef Readers[] = {"getc",    "fgetc",    "getc_unlocked",
+                                      "getchar", "fgets",    "fread",
+                                      "getline", "getdelim", "read"};
+  const SeminalLibraryCatalog &catalog = SeminalLibraryCatalog::get();
+
+  unsigned count = 0;
+  for (Function &F : M) {
+    for (Instruction &inst : instructions(F)) {
+      CallInst *call = dyn_cast<CallInst>(&inst);
+      const SeminalLibraryModel *model = call ? catalog.lookup(call) : nullptr;
+      if (!model || !model->isSource()) {
+        continue;
+      }
+      Function *callee = call->getCalledFunction();
+      StringRef name = SeminalLibraryCatalog::normalizeName(callee->getName());
+      if (std::find(std::begin(Readers), std::end(Readers), name) ==
+          std::end(Readers)) {
+        continue;
+      }
+      call->setCalledFunction(M.getOrInsertFunction(
+          ("__seminal_" + name).str(), callee->getFunctionType()));
+      ++count;
+    }
+  }
+  return count;
+}
+
+/**
+ * Returns the element index a store writes in a buffer feature: the last
+ * index of a GEP into the feature's array, or into the memory its pointer
+ * points to.
+ *
+ * @param store The store.
+ * @param feature A buffer length feature.
+ * @return The index, or null if the store does not write the buffer.
+ */
+static Value *getBufferIndex(StoreInst *store, const SnapshotFeature &feature) {
+  GetElementPtrInst *gep = dyn_cast<GetElementPtrInst>(
+      store->getPointerOperand()->stripPointerCasts());
+  if (!gep || gep->getNumIndices() == 0) {
+    return nullptr;
+  }
+  const DataLayout &DL = store->getModule()->getDataLayout();
+
+  // The indices before the last must be constant and lead to the elements
+  SmallVector<Value *, 4> prefix(gep->idx_begin(), gep->idx_end() - 1);
+  for (Value *index : prefix) {
+    if (!isa<ConstantInt>(index)) {
+      return nullptr;
+    }
+  }
+  int64_t prefixOffset =
+      prefix.empty()
+          ? 0
+          : DL.getIndexedOffsetInType(gep->getSourceElementType(), prefix);
+
+  DIType *type = stripDebugQualifiers(feature.type);
+  bool isArray = isa<DICompositeType>(type);
+  Value *base = gep->getPointerOperand();
+  if (!isArray) {
+    LoadInst *load = dyn_cast<LoadInst>(base->stripPointerCasts());
+    if (!load || prefixOffset != 0) {
+      return nullptr;
+    }
+    base = load->getPointerOperand();
+  }
+  int64_t offset = 0;
+  if (GetPointerBaseWithConstantOffset(base, offset, DL) != feature.storage ||
+      offset + (isArray ? prefixOffset : 0) != (int64_t)feature.offset) {
+    return nullptr;
+  }
+  return *(gep->idx_end() - 1);
+}
+
+/**
+ * Keeps, for each store into a buffer length feature, the highest index it
+ * has written plus one in a counter of its own: one compare and one store
+ * per write.
+ *
+ * @param M The module to instrument.
+ * @param feature A buffer length feature with its storage found.
+ * @param marks The counters added, with the lines of their stores.
+ */
+static void trackBufferWrites(
+    Module &M, const SnapshotFeature &feature,
+    std::vector<std::pair<GlobalVariable *, unsigned>> *marks) {
+  DIType *type = stripDebugQualifiers(feature.type);
+  DICompositeType *composite = dyn_cast_or_null<DICompositeType>(type);
+  DIDerivedType *pointer = dyn_cast_or_null<DIDerivedType>(type);
+  if (!(composite && composite->getTag() == dwarf::DW_TAG_array_type) &&
+      !(pointer && pointer->getTag() == dwarf::DW_TAG_pointer_type &&
+        !isFileType(pointer->getBaseType()))) {
+    return;
+  }
+
+  std::vector<std::pair<StoreInst *, Value *>> writes;
+  for (Function &F : M) {
+    if (isa<AllocaInst>(feature.storage) &&
+        cast<AllocaInst>(feature.storage)->getFunction() != &F) {
+      continue;
+    }
+    for (Instruction &inst : instructions(F)) {
+      StoreInst *store = dyn_cast<StoreInst>(&inst);
+      if (Value *index = store ? getBufferIndex(store, feature) : nullptr) {
+        writes.push_back({store, index});
+      }
+    }
+  }
+
+  Type *Int64Ty = Type::getInt64Ty(M.getContext());
+  for (auto [store, index] : writes) {
+    GlobalVariable *mark = new GlobalVariable(
+        M, Int64Ty, false, GlobalValue::InternalLinkage,
+        ConstantInt::get(Int64Ty, 0), "seminal.hwm." + feature.name);
+    IRBuilder<> builder(store->getNextNode());
+    Value *end = builder.CreateAdd(
+        builder.CreateSExtOrTrunc(index, Int64Ty), builder.getInt64(1));
+    Value *high = builder.CreateLoad(Int64Ty, mark);
+    builder.CreateStore(
+        builder.CreateSelect(builder.CreateICmpSGT(end, high), end, high),
+        mark);
+    const DebugLoc &loc = store->getDebugLoc();
+    marks->push_back({mark, loc ? loc.getLine() : 0});
+  }
+}
+
+/**
+ * Returns `function:line` for an instruction, the line being 0 without debug
+ * info.
+ */
+static std::string getSiteName(const Instruction *inst) {
+  const DebugLoc &loc = inst->getDebugLoc();
+  return (inst->getFunction()->getName() + ":" +
+          Twine(loc ? loc.getLine() : 0))
+      .str();
+}
+
+/**
+ * Adds counters of loop iterations and branch directions to every function:
+ * one per loop, incremented in its header, and two per conditional branch,
+ * incremented by its condition and its negation. The counters are the
+ * elements of one global array.
+ *
+ * @param M The module to instrument.
+ * @param FAM The function analysis manager providing loop info.
+ * @param columns The names of the counters, in array order: `loop@f:line`,
+ * `br@f:line:true` and `br@f:line:false`.
+ * @return The counter array, or null if there is nothing to count.
+ */
+static GlobalVariable *addRunCounters(Module &M, FunctionAnalysisManager &FAM,
+                                      std::vector<std::string> *columns) {
+  // A loop is named by its start line, as the detector reports it
+  std::vector<std::pair<BasicBlock *, std::string>> headers;
+  std::vector<BranchInst *> branches;
+  for (Function &F : M) {
+    if (F.isDeclaration()) {
+      continue;
+    }
+    LoopInfo &LI = FAM.getResult<LoopAnalysis>(F);
+    for (Loop *loop : LI.getLoopsInPreorder()) {
+      DebugLoc start = loop->getStartLoc();
+      headers.push_back(
+          {loop->getHeader(),
+           (F.getName() + ":" + Twine(start ? start.getLine() : 0)).str()});
+    }
+    for (BasicBlock &BB : F) {
+      BranchInst *branch = dyn_cast<BranchInst>(BB.getTerminator());
+      if (branch && branch->isConditional()) {
+        branches.push_back(branch);
+      }
+    }
+  }
+  if (headers.empty() && branches.empty()) {
+    return nullptr;
+  }
+
+  Type *Int64Ty = Type::getInt64Ty(M.getContext());
+  ArrayType *arrayTy =
+      ArrayType::get(Int64Ty, headers.size() + 2 * branches.size());
+  GlobalVariable *counters = new GlobalVariable(
+      M, arrayTy, false, GlobalValue::InternalLinkage,
+      ConstantAggregateZero::get(arrayTy), "seminal.counters");
+
+  auto addTo = [&](IRBuilder<> &builder, Value *amount) {
+    Value *counter = builder.CreateConstInBoundsGEP2_64(arrayTy, counters, 0,
+                                                        columns->size());
+    builder.CreateStore(
+        builder.CreateAdd(builder.CreateLoad(Int64Ty, counter), amount),
+        counter);
+  };
+  for (const auto &[header, name] : headers) {
+    IRBuilder<> builder(&*header->getFirstInsertionPt());
+    addTo(builder, builder.getInt64(1));
+    columns->push_back("loop@" + name);
+  }
+  for (BranchInst *branch : branches) {
+    IRBuilder<> builder(branch);
+    Value *taken = builder.CreateZExt(branch->getCondition(), Int64Ty);
+    addTo(builder, taken);
+    columns->push_back("br@" + getSiteName(branch) + ":true");
+    addTo(builder, builder.CreateSub(builder.getInt64(1), taken));
+    columns->push_back("br@" + getSiteName(branch) + ":false");
+  }
+  return counters;
+}
+
+// ---- END HELPER FUNCTIONS ----
+
+// ---- PASS DEFINITION ----
+
+/**
+ * Executes the Seminal Instrumenter pass on a module.
+ *
+ * @param M The module to instrument.
+ * @param MAM The module analysis manager providing the function analyses.
+ * @return The preserved analyses after the pass runs.
+ */
+PreservedAnalyses SeminalInstrumenterPass::run(Module &M,
+                                               ModuleAnalysisManager &MAM) {
+  std::vector<SnapshotFeature> features;
+  if (!readFeatures(FeaturesFile, &features)) {
+    llvm::errs() << "Error: Could not read seminal features from "
+                 << FeaturesFile << ".\n";
+    return PreservedAnalyses::all();
+  }
+
+  unsigned cachedInputSites = 0;
+  unsigned inputSites = WrapInput ? wrapInputCalls(M, &cachedInputSites) : 0;
+  unsigned streamReads = CountInput ? wrapStreamReads(M) : 0;
+
+  // The reads of each feature, grouped by the function they happen in
+  std::map<Function *, std::vector<Instruction *>> readsOf;
+  std::map<Function *, std::vector<const SnapshotFeature *>> featuresOf;
+  std::map<const SnapshotFeature *,
+           std::vector<std::pair<GlobalVariable *, unsigned>>>
+      marksOf;
+  for (SnapshotFeature &feature : features) {
+    feature.storage = findFeatureStorage(M, feature.name, feature.line,
+                                         &feature.offset, &feature.type);
+    if (!feature.storage) {
+      llvm::errs() << "Warning: No storage found for seminal feature "
+                   << feature.name << ".\n";
+      continue;
+    }
+    if (TrackBuffers && feature.length) {
+      trackBufferWrites(M, feature, &marksOf[&feature]);
+    }
+
+    std::vector<Instruction *> reads;
+    collectReads(M, feature.storage, &reads);
+    std::set<Function *> functions;
+    for (Instruction *read : reads) {
+      readsOf[read->getFunction()].push_back(read);
+      functions.insert(read->getFunction());
+    }
+    for (Function *F : functions) {
+      featuresOf[F].push_back(&feature);
+    }
+  }
+
+  FunctionAnalysisManager &FAM =
+      MAM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  Type *VoidTy = Type::getVoidTy(M.getContext());
+  FunctionCallee flush = M.getOrInsertFunction(
+      "__seminal_snapshot_flush", FunctionType::get(VoidTy, false));
+
+  for (auto it = featuresOf.begin(); it != featuresOf.end(); ++it) {
+    Function *F = it->first;
+    DominatorTree &DT = FAM.getResult<DominatorTreeAnalysis>(*F);
+    PostDominatorTree &PDT = FAM.getResult<PostDominatorTreeAnalysis>(*F);
+    LoopInfo &LI = FAM.getResult<LoopAnalysis>(*F);
+
+    Instruction *point = findSnapshotPoint(readsOf[F], DT, PDT, LI);
+    if (!point) {
+      llvm::errs() << "Warning: No snapshot point found in " << F->getName()
+                   << ".\n";
+      continue;
+    }
+
+    IRBuilder<> builder(point);
+    for (const SnapshotFeature *feature : it->second) {
+      if (!insertRecord(builder, *feature)) {
+        llvm::errs() << "Warning: Cannot record seminal feature "
+                     << feature->name << ".\n";
+      }
+    }
+    builder.CreateCall(flush);
+  }
+
+  // The dataset columns: times, then features, then counters
+  std::vector<std::string> featureColumns;
+  std::vector<std::string> counterColumns;
+  GlobalVariable *counters = nullptr;
+  if (!DatasetFile.empty()) {
+    for (const SnapshotFeature &feature : features) {
+      featureColumns.push_back(feature.length ? "len(" + feature.name + ")"
+                                              : feature.name);
+    }
+    counters = addRunCounters(M, FAM, &counterColumns);
+
+    std::error_code EC;
+    raw_fd_ostream schema(DatasetFile + ".schema", EC);
+    if (EC) {
+      llvm::errs() << "Error: Could not write " << DatasetFile
+                   << ".schema.\n";
+    } else {
+      schema << "wall_ns\ncpu_ns\n";
+      for (const std::string &column : featureColumns) {
+        schema << column << "\n";
+      }
+      for (const std::string &column : counterColumns) {
+        schema << column << "\n";
+      }
+    }
+  }
+
+  // Set the snapshot target before anything is recorded
+  if (Function *main = M.getFunction("main")) {
+    if (!main->isDeclaration()) {
+      IRBuilder<> builder(&*main->getEntryBlock().getFirstInsertionPt());
+      FunctionCallee init = M.getOrInsertFunction(
+          "__seminal_snapshot_init",
+          FunctionType::get(VoidTy,
+                            {builder.getInt8PtrTy(), builder.getInt32Ty()},
+                            false));
+      builder.CreateCall(init, {builder.CreateGlobalStringPtr(SnapshotTarget),
+                                builder.getInt32(SnapshotShared)});
+      if (inputSites) {
+        FunctionCallee initLog = M.getOrInsertFunction(
+            "__seminal_input_log_init",
+            FunctionType::get(VoidTy,
+                              {builder.getInt8PtrTy(), builder.getInt32Ty()},
+                              false));
+        builder.CreateCall(initLog, {builder.CreateGlobalStringPtr(InputLog),
+                                     builder.getInt32(cachedInputSites)});
+      }
+      if (streamReads) {
+        FunctionCallee initIO = M.getOrInsertFunction(
+            "__seminal_io_init",
+            FunctionType::get(VoidTy, {builder.getInt8PtrTy()}, false));
+        builder.CreateCall(initIO,
+                           {builder.CreateGlobalStringPtr(InputSummary)});
+      }
+      if (!DatasetFile.empty()) {
+        std::vector<Constant *> names;
+        for (const std::string &column : featureColumns) {
+          names.push_back(builder.CreateGlobalStringPtr(column));
+        }
+        ArrayType *namesTy =
+            ArrayType::get(builder.getInt8PtrTy(), names.size());
+        GlobalVariable *namesArray = new GlobalVariable(
+            M, namesTy, true, GlobalValue::InternalLinkage,
+            ConstantArray::get(namesTy, names), "seminal.dataset.features");
+        Value *counterArray =
+            counters ? builder.CreatePointerCast(counters,
+                                                 builder.getInt8PtrTy())
+                     : ConstantPointerNull::get(builder.getInt8PtrTy());
+
+        FunctionCallee initDataset = M.getOrInsertFunction(
+            "__seminal_dataset_init",
+            FunctionType::get(VoidTy,
+                              {builder.getInt8PtrTy(), builder.getInt8PtrTy(),
+                               builder.getInt32Ty(), builder.getInt8PtrTy(),
+                               builder.getInt32Ty()},
+                              false));
+        builder.CreateCall(
+            initDataset,
+            {builder.CreateGlobalStringPtr(DatasetFile),
+             builder.CreatePointerCast(namesArray, builder.getInt8PtrTy()),
+             builder.getInt32(names.size()), counterArray,
+             builder.getInt32(counterColumns.size())});
+      }
+      if (TrackBuffers) {
+        FunctionCallee trackBuffer = M.getOrInsertFunction(
+            "__seminal_track_buffer",
+            FunctionType::get(VoidTy,
+                              {builder.getInt8PtrTy(), builder.getInt32Ty(),
+                               builder.getInt8PtrTy()},
+                              false));
+        for (const SnapshotFeature &feature : features) {
+          for (const auto &[mark, line] : marksOf[&feature]) {
+            builder.CreateCall(
+                trackBuffer,
+                {builder.CreateGlobalStringPtr("hwm(" + feature.name + ")"),
+                 builder.getInt32(line),
+                 builder.CreatePointerCast(mark, builder.getInt8PtrTy())});
+          }
+        }
+      }
+    }
+  }
+
+  return PreservedAnalyses::none();
+}
+// ---- END PASS DEFINITION ----
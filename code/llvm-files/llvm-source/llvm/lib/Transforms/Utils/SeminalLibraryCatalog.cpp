@@ -0,0 +1,122 @@
+/**
+ * Library input sources and flow models for the Seminal Input Detector.
+ *
+ * @file SeminalLibraryCatalog.cpp
+ * @brief Loads the declarative catalog of SeminalLibraryCatalog.def: which
+ * library functions produce external input, and how data moves between the
+ * arguments and the result of the others. The detector consults it instead
+ * of matching function names by substring or walking every argument of a
+ * library call.
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#include "llvm/Transforms/Utils/SeminalLibraryCatalog.h"
+
+#include "llvm/IR/Function.h"
+
+using namespace llvm;
+
+SmallVector<Value *, 4>
+SeminalEndpoint::getArguments(const CallBase *Call) const {
+  SmallVector<Value *, 4> arguments;
+  switch (kind) {
+  case Ret:
+  case RetMem:
+    break;
+  case Arg:
+  case Mem:
+    if (index < Call->arg_size()) {
+      arguments.push_back(Call->getArgOperand(index));
+    }
+    break;
+  case ArgsFrom:
+  case MemFrom:
+    for (unsigned i = index; i < Call->arg_size(); ++i) {
+      arguments.push_back(Call->getArgOperand(i));
+    }
+    break;
+  }
+  return arguments;
+}
+
+bool SeminalLibraryModel::writesMemory() const {
+  for (const SeminalEndpoint &source : sources) {
+    if (source.isMemory()) {
+      return true;
+    }
+  }
+  for (const SeminalFlow &flow : flows) {
+    if (flow.to.isMemory()) {
+      return true;
+    }
+  }
+  return writesReturnedMemory();
+}
+
+bool SeminalLibraryModel::writesArgument(unsigned ArgNo) const {
+  for (const SeminalEndpoint &source : sources) {
+    if (source.coversMemory(ArgNo)) {
+      return true;
+    }
+  }
+  for (const SeminalFlow &flow : flows) {
+    if (flow.to.coversMemory(ArgNo)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SeminalLibraryModel::writesReturnedMemory() const {
+  for (const SeminalFlow &flow : flows) {
+    if (flow.to.kind == SeminalEndpoint::RetMem) {
+      return true;
+    }
+  }
+  return false;
+}
+
+SeminalLibraryCatalog::SeminalLibraryCatalog() {
+#define SEMINAL_INPUT_SOURCE(NAME, KIND, INDEX)                                \
+  models[NAME].sources.push_back({SeminalEndpoint::KIND, INDEX});
+#define SEMINAL_FLOW(NAME, FROM_KIND, FROM_INDEX, TO_KIND, TO_INDEX)           \
+  models[NAME].flows.push_back({{SeminalEndpoint::FROM_KIND, FROM_INDEX},      \
+                                {SeminalEndpoint::TO_KIND, TO_INDEX}});
+#define SEMINAL_NO_FLOW(NAME) models[NAME];
+#define SEMINAL_ALLOCATION_SIZE(NAME, INDEX)                                   \
+  models[NAME].sizeArguments.push_back(INDEX);
+#define SEMINAL_OUTPUT(NAME) models[NAME].output = true;
+#include "llvm/Transforms/Utils/SeminalLibraryCatalog.def"
+}
+
+const SeminalLibraryCatalog &SeminalLibraryCatalog::get() {
+  static const SeminalLibraryCatalog catalog;
+  return catalog;
+}
+
+StringRef SeminalLibraryCatalog::normalizeName(StringRef Name) {
+  // Intrinsics carry their overload types as suffixes
+  if (Name.consume_front("llvm.")) {
+    return Name.take_until([](char c) { return c == '.'; });
+  }
+
+  Name.consume_front("__isoc99_");
+  Name.consume_front("_IO_");
+  return Name;
+}
+
+const SeminalLibraryModel *
+SeminalLibraryCatalog::lookup(const CallBase *Call) const {
+  const Function *callee = Call ? Call->getCalledFunction() : nullptr;
+  if (!callee || !callee->isDeclaration()) {
+    return nullptr;
+  }
+
+  auto it = models.find(normalizeName(callee->getName()));
+  return it == models.end() ? nullptr : &it->second;
+}
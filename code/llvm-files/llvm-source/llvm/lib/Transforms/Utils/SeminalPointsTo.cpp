@@ -0,0 +1,430 @@
+/**
+ * Unification-based points-to analysis for the Seminal Input Detector.
+ *
+ * @file SeminalPointsTo.cpp
+ * @brief Steensgaard-style points-to analysis used to propagate input taint
+ * through memory. Every address-carrying value is a node in a union-find
+ * forest and each node points to at most one other node; assignments unify
+ * pointees instead of adding subset constraints, so the whole module is
+ * solved in a single near-linear pass instead of a cubic (Andersen) fixpoint.
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#include "llvm/Transforms/Utils/SeminalPointsTo.h"
+
+#include <algorithm>
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Transforms/Utils/SeminalLibraryCatalog.h"
+
+using namespace llvm;
+
+// ---- HELPER FUNCTIONS ----
+
+/**
+ * Strips constant casts and constant GEPs, which address the same object as
+ * their base.
+ *
+ * @param V The value to canonicalize.
+ * @return The value the node of V is keyed on.
+ */
+static const Value *canonical(const Value *V) {
+  while (const ConstantExpr *CE = dyn_cast<ConstantExpr>(V)) {
+    if (!CE->isCast() && CE->getOpcode() != Instruction::GetElementPtr) {
+      break;
+    }
+    V = CE->getOperand(0);
+  }
+  return V;
+}
+
+/**
+ * Returns true if a library call returns (a pointer into) its first argument,
+ * e.g. `strcpy` or `fgets`, as recorded by the library catalog.
+ *
+ * @param call The call of a library function.
+ */
+static bool returnsFirstArgument(const CallBase *call) {
+  const SeminalLibraryModel *model = SeminalLibraryCatalog::get().lookup(call);
+  if (!model) {
+    return false;
+  }
+  for (const SeminalFlow &flow : model->flows) {
+    if (flow.from.kind == SeminalEndpoint::Arg && flow.from.index == 0 &&
+        flow.to.kind == SeminalEndpoint::Ret) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SeminalPointsTo::isHeapAllocation(const Value *V) {
+  const SeminalLibraryModel *model =
+      SeminalLibraryCatalog::get().lookup(dyn_cast<CallBase>(V));
+  return model && model->returnsHeapMemory();
+}
+
+// ---- END HELPER FUNCTIONS ----
+
+// ---- UNION-FIND ----
+
+/**
+ * Returns the node of a value, creating a fresh singleton node on first use.
+ */
+unsigned SeminalPointsTo::getNode(const Value *V) {
+  auto inserted = nodes.try_emplace(canonical(V), parent.size());
+  if (inserted.second) {
+    parent.push_back(parent.size());
+    rank.push_back(0);
+    pointee.push_back(NoClass);
+  }
+  return inserted.first->second;
+}
+
+/**
+ * Returns the node standing for the values a function returns.
+ */
+unsigned SeminalPointsTo::getReturnNode(const Function *F) {
+  auto inserted = returnNodes.try_emplace(F, parent.size());
+  if (inserted.second) {
+    parent.push_back(parent.size());
+    rank.push_back(0);
+    pointee.push_back(NoClass);
+  }
+  return inserted.first->second;
+}
+
+/**
+ * Returns the node a node points to, creating an empty one on first use.
+ */
+unsigned SeminalPointsTo::getPointee(unsigned Node) {
+  unsigned root = find(Node);
+  if (pointee[root] == NoClass) {
+    unsigned fresh = parent.size();
+    parent.push_back(fresh);
+    rank.push_back(0);
+    pointee.push_back(NoClass);
+    pointee[root] = fresh;
+  }
+  return find(pointee[root]);
+}
+
+/**
+ * Returns the representative of a node, compressing the path to it.
+ */
+unsigned SeminalPointsTo::find(unsigned Node) {
+  unsigned root = Node;
+  while (parent[root] != root) {
+    root = parent[root];
+  }
+
+  while (parent[Node] != root) {
+    unsigned next = parent[Node];
+    parent[Node] = root;
+    Node = next;
+  }
+  return root;
+}
+
+/**
+ * Unifies two nodes and, transitively, everything they point to.
+ */
+void SeminalPointsTo::join(unsigned A, unsigned B) {
+  std::vector<std::pair<unsigned, unsigned>> worklist = {{A, B}};
+  while (!worklist.empty()) {
+    unsigned a = find(worklist.back().first);
+    unsigned b = find(worklist.back().second);
+    worklist.pop_back();
+    if (a == b) {
+      continue;
+    }
+
+    // Union by rank keeps the trees shallow
+    if (rank[a] < rank[b]) {
+      std::swap(a, b);
+    }
+    parent[b] = a;
+    if (rank[a] == rank[b]) {
+      ++rank[a];
+    }
+
+    // A node has a single pointee, so the pointees have to be unified too
+    if (pointee[a] == NoClass) {
+      pointee[a] = pointee[b];
+    } else if (pointee[b] != NoClass) {
+      worklist.push_back({pointee[a], pointee[b]});
+    }
+  }
+}
+
+// ---- END UNION-FIND ----
+
+// ---- CONSTRAINTS ----
+
+/** Ptr = &Object */
+void SeminalPointsTo::addressOf(const Value *Ptr, const Value *Object) {
+  unsigned objectNode = getPointee(getNode(Ptr));
+  objects[objectNode].push_back(Object);
+}
+
+/** Dst = Src */
+void SeminalPointsTo::copy(const Value *Dst, const Value *Src) {
+  join(getPointee(getNode(Dst)), getPointee(getNode(Src)));
+}
+
+/** Dst = *Ptr */
+void SeminalPointsTo::load(const Value *Dst, const Value *Ptr) {
+  join(getPointee(getNode(Dst)), getPointee(getPointee(getNode(Ptr))));
+}
+
+/** *Ptr = Src */
+void SeminalPointsTo::store(const Value *Ptr, const Value *Src) {
+  join(getPointee(getPointee(getNode(Ptr))), getPointee(getNode(Src)));
+}
+
+/**
+ * Adds the constraints of a call: formals and returns of defined callees,
+ * heap allocation sites, and library functions that return an argument.
+ *
+ * @param Call The call to model.
+ * @param AddressTaken The functions an indirect call may reach.
+ */
+void SeminalPointsTo::visitCall(CallBase *Call,
+                                ArrayRef<Function *> AddressTaken) {
+  // Block copies move the pointers stored in one buffer into another
+  if (MemTransferInst *transfer = dyn_cast<MemTransferInst>(Call)) {
+    join(getPointee(getPointee(getNode(transfer->getRawDest()))),
+         getPointee(getPointee(getNode(transfer->getRawSource()))));
+    return;
+  }
+
+  if (isa<IntrinsicInst>(Call)) {
+    return;
+  }
+
+  std::vector<Function *> callees;
+  if (Function *callee = Call->getCalledFunction()) {
+    callees.push_back(callee);
+  } else {
+    for (Function *candidate : AddressTaken) {
+      if (candidate->arg_size() == Call->arg_size()) {
+        callees.push_back(candidate);
+      }
+    }
+  }
+
+  for (Function *callee : callees) {
+    if (callee->isDeclaration()) {
+      if (!Call->getType()->isPointerTy()) {
+        continue;
+      }
+
+      if (isHeapAllocation(Call)) {
+        addressOf(Call, Call);
+        if (callee->getName() == "realloc") {
+          copy(Call, Call->getArgOperand(0));
+        }
+      } else if (returnsFirstArgument(Call) &&
+                 Call->arg_size() > 0) {
+        copy(Call, Call->getArgOperand(0));
+      } else {
+        // Opaque library memory, e.g. the FILE returned by fopen
+        addressOf(Call, Call);
+      }
+      continue;
+    }
+
+    // Bind actual arguments to formals and the callee's return to the call
+    for (unsigned i = 0; i < Call->arg_size() && i < callee->arg_size(); ++i) {
+      Value *actual = Call->getArgOperand(i);
+      if (actual->getType()->isPointerTy()) {
+        copy(callee->getArg(i), actual);
+      }
+    }
+
+    if (Call->getType()->isPointerTy()) {
+      join(getPointee(getNode(Call)), getPointee(getReturnNode(callee)));
+    }
+  }
+}
+
+// ---- END CONSTRAINTS ----
+
+/**
+ * Solves the points-to constraints of every function and global in a module.
+ *
+ * @param M The module to analyze.
+ */
+SeminalPointsTo::SeminalPointsTo(Module &M) {
+  std::vector<Function *> addressTaken;
+  for (Function &F : M) {
+    if (F.hasAddressTaken()) {
+      addressTaken.push_back(&F);
+    }
+  }
+
+  // Globals are objects, and their initializers may store addresses
+  for (GlobalVariable &GV : M.globals()) {
+    addressOf(&GV, &GV);
+    if (!GV.hasInitializer()) {
+      continue;
+    }
+
+    std::vector<const Constant *> pending = {GV.getInitializer()};
+    while (!pending.empty()) {
+      const Constant *init = pending.back();
+      pending.pop_back();
+      const Value *base = canonical(init);
+      if (isa<GlobalValue>(base)) {
+        store(&GV, base);
+      } else if (isa<ConstantAggregate>(init)) {
+        for (const Use &op : init->operands()) {
+          pending.push_back(cast<Constant>(op.get()));
+        }
+      }
+    }
+  }
+
+  for (Function &F : M) {
+    for (Instruction &I : instructions(F)) {
+      if (isa<AllocaInst>(I)) {
+        addressOf(&I, &I);
+      } else if (LoadInst *load = dyn_cast<LoadInst>(&I)) {
+        if (load->getType()->isPointerTy()) {
+          this->load(load, load->getPointerOperand());
+        }
+      } else if (StoreInst *storeInst = dyn_cast<StoreInst>(&I)) {
+        if (storeInst->getValueOperand()->getType()->isPointerTy()) {
+          store(storeInst->getPointerOperand(), storeInst->getValueOperand());
+        }
+      } else if (GetElementPtrInst *gep = dyn_cast<GetElementPtrInst>(&I)) {
+        // Field-insensitive: a GEP addresses the object of its base
+        copy(gep, gep->getPointerOperand());
+      } else if (CastInst *cast = dyn_cast<CastInst>(&I)) {
+        copy(cast, cast->getOperand(0));
+      } else if (PHINode *phi = dyn_cast<PHINode>(&I)) {
+        for (Value *incoming : phi->incoming_values()) {
+          copy(phi, incoming);
+        }
+      } else if (SelectInst *select = dyn_cast<SelectInst>(&I)) {
+        copy(select, select->getTrueValue());
+        copy(select, select->getFalseValue());
+      } else if (ReturnInst *ret = dyn_cast<ReturnInst>(&I)) {
+        Value *returned = ret->getReturnValue();
+        if (returned && returned->getType()->isPointerTy()) {
+          join(getPointee(getReturnNode(&F)), getPointee(getNode(returned)));
+        }
+      } else if (CallBase *call = dyn_cast<CallBase>(&I)) {
+        visitCall(call, addressTaken);
+      }
+    }
+  }
+
+  buildIndex(M);
+}
+
+/**
+ * Flattens the union-find forest and indexes objects and memory writers by
+ * their final class, so queries after construction are plain lookups.
+ *
+ * @param M The analyzed module.
+ */
+void SeminalPointsTo::buildIndex(Module &M) {
+  for (unsigned node = 0; node < parent.size(); ++node) {
+    find(node);
+  }
+
+  DenseMap<unsigned, std::vector<const Value *>> byClass;
+  for (auto &entry : objects) {
+    std::vector<const Value *> &sites = byClass[find(entry.first)];
+    sites.insert(sites.end(), entry.second.begin(), entry.second.end());
+  }
+  objects = std::move(byClass);
+
+  for (Function &F : M) {
+    for (Instruction &I : instructions(F)) {
+      if (StoreInst *storeInst = dyn_cast<StoreInst>(&I)) {
+        unsigned memoryClass = getMemoryClass(storeInst->getPointerOperand());
+        if (memoryClass != NoClass) {
+          writers[memoryClass].push_back(storeInst);
+        }
+        continue;
+      }
+
+      // Only external callees write memory without a visible store
+      CallBase *call = dyn_cast<CallBase>(&I);
+      if (!call || isa<DbgInfoIntrinsic>(call)) {
+        continue;
+      }
+      Function *callee = call->getCalledFunction();
+      if (callee && !callee->isDeclaration()) {
+        continue;
+      }
+      if (isa<IntrinsicInst>(call) && !isa<AnyMemIntrinsic>(call)) {
+        continue;
+      }
+
+      // Modeled library calls write only the memory their catalog names
+      const SeminalLibraryModel *model =
+          SeminalLibraryCatalog::get().lookup(call);
+      std::vector<unsigned> written;
+      auto addWriter = [&](const Value *pointer) {
+        unsigned memoryClass = getMemoryClass(pointer);
+        if (memoryClass == NoClass ||
+            std::find(written.begin(), written.end(), memoryClass) !=
+                written.end()) {
+          return;
+        }
+        written.push_back(memoryClass);
+        writers[memoryClass].push_back(call);
+      };
+      for (unsigned i = 0; i < call->arg_size(); ++i) {
+        if (!model || model->writesArgument(i)) {
+          addWriter(call->getArgOperand(i));
+        }
+      }
+      if (model && model->writesReturnedMemory() &&
+          call->getType()->isPointerTy()) {
+        addWriter(call);
+      }
+    }
+  }
+}
+
+// ---- QUERIES ----
+
+unsigned SeminalPointsTo::getMemoryClass(const Value *Ptr) const {
+  auto it = nodes.find(canonical(Ptr));
+  if (it == nodes.end()) {
+    return NoClass;
+  }
+
+  // The forest is flat after buildIndex, so parent is the representative
+  unsigned target = pointee[parent[it->second]];
+  return target == NoClass ? NoClass : parent[target];
+}
+
+ArrayRef<const Value *> SeminalPointsTo::getObjects(unsigned Class) const {
+  auto it = objects.find(Class);
+  if (it == objects.end()) {
+    return {};
+  }
+  return it->second;
+}
+
+ArrayRef<Instruction *> SeminalPointsTo::getWriters(unsigned Class) const {
+  auto it = writers.find(Class);
+  if (it == writers.end()) {
+    return {};
+  }
+  return it->second;
+}
+
+// ---- END QUERIES ----
@@ -0,0 +1,534 @@
+/**
+ * Feature-extractor slicing for the Seminal Input Detector.
+ *
+ * @file SeminalSlicer.cpp
+ * @brief Turns a program instrumented with feature snapshots into a program
+ * that only computes its seminal features. `main` exits right after the
+ * point where its last snapshot is complete, printing the feature vector;
+ * before that point, a backward slice from the snapshot, the input reads and
+ * the calls that cannot be removed keeps only the computation they depend on
+ * (operands, writers of the memory they read, and the branches they are
+ * control dependent on). Calls of functions that read input, directly or
+ * through calls, are kept as well. Everything else in `main` is deleted, and
+ * branches outside the slice jump straight to their post-dominator, so loops
+ * that do the program's work disappear. Only `main` is sliced: the functions
+ * it still calls run in full.
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#include "llvm/Transforms/Utils/SeminalSlicer.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/SeminalInputDetector.h"
+#include "llvm/Transforms/Utils/SeminalInstrumenter.h"
+#include "llvm/Transforms/Utils/SeminalLibraryCatalog.h"
+
+using namespace llvm;
+
+namespace {
+
+/** The memory an instruction may read or write. */
+struct Footprint {
+  /** Identified objects: allocas, globals and heap allocations. */
+  std::vector<const Value *> objects;
+
+  /** True if a pointer may address any object. */
+  bool unknown = false;
+
+  /** True if any global variable may be accessed. */
+  bool globals = false;
+
+  /** Returns true if no memory is accessed. */
+  bool empty() const { return objects.empty() && !unknown && !globals; }
+};
+
+} // namespace
+
+// ---- HELPER FUNCTIONS ----
+
+/**
+ * Adds the object a pointer addresses to a footprint.
+ *
+ * @param pointer The address.
+ * @param footprint The footprint to extend.
+ */
+static void addPointer(const Value *pointer, Footprint *footprint) {
+  const Value *object = getUnderlyingObject(pointer);
+  if (isIdentifiedObject(object)) {
+    footprint->objects.push_back(object);
+  } else {
+    footprint->unknown = true;
+  }
+}
+
+/**
+ * Returns the memory behind the pointer arguments of a call; a call that may
+ * reach code in the module may also access any global.
+ *
+ * @param call The call.
+ */
+static Footprint getCallFootprint(const CallBase *call) {
+  Footprint footprint;
+  for (const Value *arg : call->args()) {
+    if (arg->getType()->isPointerTy()) {
+      addPointer(arg, &footprint);
+    }
+  }
+  const Function *callee = call->getCalledFunction();
+  footprint.globals = !callee || !callee->isDeclaration();
+  return footprint;
+}
+
+/**
+ * Returns the memory an instruction may read.
+ *
+ * @param inst The instruction.
+ */
+static Footprint getReads(const Instruction *inst) {
+  Footprint footprint;
+  if (const LoadInst *load = dyn_cast<LoadInst>(inst)) {
+    addPointer(load->getPointerOperand(), &footprint);
+  } else if (const CallBase *call = dyn_cast<CallBase>(inst)) {
+    if (call->mayReadFromMemory() && !isa<DbgInfoIntrinsic>(call)) {
+      footprint = getCallFootprint(call);
+    }
+  }
+  return footprint;
+}
+
+/**
+ * Returns the memory an instruction may write. Library calls are taken from
+ * the catalog, so output and pure calls write nothing, and `strdup` writes
+ * only the copy it returns.
+ *
+ * @param inst The instruction.
+ */
+static Footprint getWrites(const Instruction *inst) {
+  Footprint footprint;
+  if (const StoreInst *store = dyn_cast<StoreInst>(inst)) {
+    addPointer(store->getPointerOperand(), &footprint);
+  } else if (const CallBase *call = dyn_cast<CallBase>(inst)) {
+    const SeminalLibraryModel *model =
+        SeminalLibraryCatalog::get().lookup(call);
+    if (!call->mayWriteToMemory() || isa<DbgInfoIntrinsic>(call)) {
+      return footprint;
+    }
+    if (!model) {
+      return getCallFootprint(call);
+    }
+    for (unsigned i = 0; i < call->arg_size(); ++i) {
+      if (model->writesArgument(i)) {
+        addPointer(call->getArgOperand(i), &footprint);
+      }
+    }
+    if (model->writesReturnedMemory()) {
+      addPointer(call, &footprint);
+    }
+  }
+  return footprint;
+}
+
+/**
+ * Returns true if a write may change memory a read depends on.
+ *
+ * @param reads The memory read.
+ * @param writes The memory written.
+ */
+static bool overlaps(const Footprint &reads, const Footprint &writes) {
+  if (reads.empty() || writes.empty()) {
+    return false;
+  }
+  if (reads.unknown || writes.unknown) {
+    return true;
+  }
+  for (const Value *object : reads.objects) {
+    if ((writes.globals && isa<GlobalVariable>(object)) ||
+        std::find(writes.objects.begin(), writes.objects.end(), object) !=
+            writes.objects.end()) {
+      return true;
+    }
+  }
+  if (reads.globals) {
+    if (writes.globals) {
+      return true;
+    }
+    for (const Value *object : writes.objects) {
+      if (isa<GlobalVariable>(object)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * Returns true if a call must stay in the extractor whatever the snapshot
+ * depends on, not counting calls of functions defined in the module: a
+ * snapshot runtime call, an input read (the input must be consumed as the
+ * program consumes it), and a call to unknown code or one that does not
+ * return.
+ *
+ * @param call The call.
+ */
+static bool isRequiredCall(CallBase *call) {
+  if (isa<IntrinsicInst>(call)) {
+    return false;
+  }
+
+  Function *callee = call->getCalledFunction();
+  if (!callee || call->doesNotReturn() ||
+      callee->getName().startswith("__seminal_")) {
+    return true;
+  }
+  if (!callee->isDeclaration()) {
+    return false;
+  }
+  const SeminalLibraryModel *model = SeminalLibraryCatalog::get().lookup(call);
+  return !model || model->isSource();
+}
+
+/**
+ * Finds the functions defined in the module that make a required call,
+ * directly or through calls: a helper that reads input (`skip_header()`)
+ * must run in the extractor even if nothing the snapshot uses depends on
+ * it, or the reads after it would see the wrong bytes.
+ *
+ * @param M The module.
+ * @return The functions reaching a required call.
+ */
+static std::set<Function *> findRequiredFunctions(Module &M) {
+  std::set<Function *> required;
+  std::vector<Function *> worklist;
+  for (Function &F : M) {
+    for (Instruction &inst : instructions(F)) {
+      CallBase *call = dyn_cast<CallBase>(&inst);
+      if (call && isRequiredCall(call) && required.insert(&F).second) {
+        worklist.push_back(&F);
+        break;
+      }
+    }
+  }
+
+  while (!worklist.empty()) {
+    Function *F = worklist.back();
+    worklist.pop_back();
+    for (User *user : F->users()) {
+      CallBase *call = dyn_cast<CallBase>(user);
+      if (call && call->getCalledFunction() == F &&
+          required.insert(call->getFunction()).second) {
+        worklist.push_back(call->getFunction());
+      }
+    }
+  }
+  return required;
+}
+
+/**
+ * Returns true if an instruction must stay in the extractor whatever the
+ * snapshot depends on: a required call, a call of a function that makes
+ * one, and terminators other than branches.
+ *
+ * @param inst The instruction.
+ * @param required The functions reaching a required call.
+ */
+static bool isCriterion(Instruction *inst,
+                        const std::set<Function *> &required) {
+  if (inst->isTerminator()) {
+    return !isa<BranchInst>(inst) && !isa<SwitchInst>(inst);
+  }
+  CallBase *call = dyn_cast<CallBase>(inst);
+  if (!call) {
+    return false;
+  }
+  Function *callee = call->getCalledFunction();
+  return isRequiredCall(call) ||
+         (callee && !callee->isDeclaration() && required.count(callee));
+}
+
+/**
+ * Finds the functions that take a snapshot, directly or through calls.
+ *
+ * @param M The module.
+ * @return The functions reaching `__seminal_snapshot_flush`.
+ */
+static std::set<Function *> findSnapshotFunctions(Module &M) {
+  std::set<Function *> reaching;
+  std::vector<Function *> worklist;
+  if (Function *flush = M.getFunction("__seminal_snapshot_flush")) {
+    worklist.push_back(flush);
+  }
+
+  while (!worklist.empty()) {
+    Function *F = worklist.back();
+    worklist.pop_back();
+    for (User *user : F->users()) {
+      CallBase *call = dyn_cast<CallBase>(user);
+      if (call && call->getCalledFunction() == F &&
+          reaching.insert(call->getFunction()).second) {
+        worklist.push_back(call->getFunction());
+      }
+    }
+  }
+  return reaching;
+}
+
+/**
+ * Makes `main` exit, printing the features, once its last snapshot is
+ * complete; the code after that point becomes unreachable and is removed.
+ * A snapshot taken inside a loop is complete at the loop's exit, not after
+ * its first iteration.
+ *
+ * @param main The program's entry.
+ * @param FAM The function analysis manager.
+ * @return False if `main` never takes a snapshot.
+ */
+static bool insertExit(Function *main, FunctionAnalysisManager &FAM) {
+  Module *M = main->getParent();
+  std::set<Function *> reaching = findSnapshotFunctions(*M);
+  Function *flush = M->getFunction("__seminal_snapshot_flush");
+
+  DominatorTree &DT = FAM.getResult<DominatorTreeAnalysis>(*main);
+  PostDominatorTree &PDT = FAM.getResult<PostDominatorTreeAnalysis>(*main);
+  LoopInfo &LI = FAM.getResult<LoopAnalysis>(*main);
+  std::vector<Instruction *> points;
+  for (Instruction &inst : instructions(*main)) {
+    CallBase *call = dyn_cast<CallBase>(&inst);
+    Function *callee = call ? call->getCalledFunction() : nullptr;
+    if (callee && (callee == flush || reaching.count(callee))) {
+      Instruction *point = getCompletionPoint(call, LI, PDT);
+      if (!point) {
+        return false;
+      }
+      points.push_back(point);
+    }
+  }
+  if (points.empty()) {
+    return false;
+  }
+
+  Instruction *point = findLatestPoint(points, DT, PDT);
+  if (!point) {
+    return false;
+  }
+
+  IRBuilder<> builder(point);
+  FunctionCallee exit = M->getOrInsertFunction(
+      "__seminal_snapshot_exit",
+      FunctionType::get(builder.getVoidTy(), false));
+  builder.CreateCall(exit);
+  changeToUnreachable(point);
+  removeUnreachableBlocks(*main);
+  FAM.invalidate(*main, PreservedAnalyses::none());
+  return true;
+}
+
+/**
+ * Computes the backward slice of a function from its criteria: operands,
+ * the writers of memory a sliced instruction reads, the branches it is
+ * control dependent on, and, for a phi, the branches choosing its incoming
+ * value. A branch outside the slice that cannot jump to its post-dominator
+ * (there is none, or it merges values in phis) is added to the slice.
+ *
+ * @param F The function to slice.
+ * @param PDT The post-dominator tree of F.
+ * @param CD The control dependences of F.
+ * @param required The functions reaching a required call.
+ * @return The instructions in the slice.
+ */
+static std::set<Instruction *>
+computeSlice(Function &F, PostDominatorTree &PDT,
+             const SeminalControlDependence &CD,
+             const std::set<Function *> &required) {
+  std::vector<std::pair<Instruction *, Footprint>> writers;
+  for (Instruction &inst : instructions(F)) {
+    Footprint writes = getWrites(&inst);
+    if (!writes.empty()) {
+      writers.push_back({&inst, writes});
+    }
+  }
+
+  std::set<Instruction *> slice;
+  std::vector<Instruction *> worklist;
+  auto add = [&](Instruction *inst) {
+    if (slice.insert(inst).second) {
+      worklist.push_back(inst);
+    }
+  };
+  for (Instruction &inst : instructions(F)) {
+    if (isCriterion(&inst, required)) {
+      add(&inst);
+    }
+  }
+
+  bool changed = true;
+  while (changed) {
+    while (!worklist.empty()) {
+      Instruction *inst = worklist.back();
+      worklist.pop_back();
+
+      for (Value *operand : inst->operands()) {
+        if (Instruction *def = dyn_cast<Instruction>(operand)) {
+          add(def);
+        }
+      }
+      if (PHINode *phi = dyn_cast<PHINode>(inst)) {
+        for (BasicBlock *incoming : phi->blocks()) {
+          add(incoming->getTerminator());
+        }
+      }
+      for (Instruction *terminator :
+           CD.getControllingTerminators(inst->getParent())) {
+        add(terminator);
+      }
+
+      Footprint reads = getReads(inst);
+      if (!reads.empty()) {
+        for (auto &writer : writers) {
+          if (overlaps(reads, writer.second)) {
+            add(writer.first);
+          }
+        }
+      }
+    }
+
+    changed = false;
+    for (BasicBlock &block : F) {
+      Instruction *terminator = block.getTerminator();
+      if (slice.count(terminator) || terminator->getNumSuccessors() < 2) {
+        continue;
+      }
+      DomTreeNode *node = PDT.getNode(&block);
+      BasicBlock *join = node && node->getIDom() ? node->getIDom()->getBlock()
+                                                 : nullptr;
+      if (!join || isa<PHINode>(join->front())) {
+        add(terminator);
+        changed = true;
+      }
+    }
+  }
+  return slice;
+}
+
+/**
+ * Deletes what is outside the slice of a function: unsliced instructions
+ * are erased, and unsliced branches jump straight to their immediate
+ * post-dominator.
+ *
+ * @param F The function to reduce.
+ * @param slice The instructions to keep.
+ * @param PDT The post-dominator tree of F.
+ */
+static void removeOutsideSlice(Function &F,
+                               const std::set<Instruction *> &slice,
+                               PostDominatorTree &PDT) {
+  std::vector<Instruction *> dead;
+  std::vector<BasicBlock *> bypassed;
+  for (BasicBlock &block : F) {
+    for (Instruction &inst : block) {
+      if (slice.count(&inst) || isa<AllocaInst>(&inst) ||
+          isa<DbgInfoIntrinsic>(&inst)) {
+        continue;
+      }
+      if (inst.isTerminator()) {
+        if (inst.getNumSuccessors() > 1) {
+          bypassed.push_back(&block);
+        }
+        continue;
+      }
+      dead.push_back(&inst);
+    }
+  }
+
+  for (Instruction *inst : dead) {
+    inst->replaceAllUsesWith(PoisonValue::get(inst->getType()));
+  }
+  for (Instruction *inst : dead) {
+    inst->eraseFromParent();
+  }
+
+  for (BasicBlock *block : bypassed) {
+    BasicBlock *join = PDT.getNode(block)->getIDom()->getBlock();
+    Instruction *terminator = block->getTerminator();
+    std::set<BasicBlock *> successors(succ_begin(block), succ_end(block));
+    for (BasicBlock *successor : successors) {
+      if (successor != join) {
+        successor->removePredecessor(block);
+      }
+    }
+    BranchInst::Create(join, terminator);
+    terminator->eraseFromParent();
+  }
+  removeUnreachableBlocks(F);
+}
+
+// ---- END HELPER FUNCTIONS ----
+
+// ---- PASS DEFINITION ----
+
+/**
+ * Executes the Seminal Slicer pass on a module.
+ *
+ * @param M The module to reduce; instrumented by the Seminal Instrumenter.
+ * @param MAM The module analysis manager providing the function analyses.
+ * @return The preserved analyses after the pass runs.
+ */
+PreservedAnalyses SeminalSlicerPass::run(Module &M,
+                                         ModuleAnalysisManager &MAM) {
+  Function *main = M.getFunction("main");
+  if (!main || main->isDeclaration()) {
+    llvm::errs() << "Error: No main function to slice.\n";
+    return PreservedAnalyses::all();
+  }
+
+  FunctionAnalysisManager &FAM =
+      MAM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  if (!insertExit(main, FAM)) {
+    llvm::errs() << "Error: main takes no feature snapshot; run "
+                    "seminal-instrument first.\n";
+    return PreservedAnalyses::all();
+  }
+
+  PostDominatorTree &PDT = FAM.getResult<PostDominatorTreeAnalysis>(*main);
+  const SeminalControlDependence &CD =
+      FAM.getResult<SeminalControlDependenceAnalysis>(*main);
+  std::set<Instruction *> slice =
+      computeSlice(*main, PDT, CD, findRequiredFunctions(M));
+  removeOutsideSlice(*main, slice, PDT);
+
+  // Output elsewhere is dropped where nothing uses its result
+  for (Function &F : M) {
+    std::vector<Instruction *> outputs;
+    for (Instruction &inst : instructions(F)) {
+      CallBase *call = dyn_cast<CallBase>(&inst);
+      const SeminalLibraryModel *model =
+          call ? SeminalLibraryCatalog::get().lookup(call) : nullptr;
+      if (model && model->output && call->use_empty()) {
+        outputs.push_back(call);
+      }
+    }
+    for (Instruction *inst : outputs) {
+      inst->eraseFromParent();
+    }
+  }
+
+  return PreservedAnalyses::none();
+}
+// ---- END PASS DEFINITION ----
@@ -0,0 +1,582 @@
+/**
+ * Value-profile-driven specialization for the Seminal Input Detector.
+ *
+ * @file SeminalSpecializer.cpp
+ * @brief Reads a value profile (the feature snapshots of profiled runs) and
+ * finds the values a seminal input takes in most runs, e.g. a 10x10 board
+ * size. For each hot value, loops whose exits depend on the feature are
+ * versioned under `if (feature == value)`, and calls passing the feature to
+ * a function are redirected to a clone with the argument replaced by the
+ * constant. Later optimization can then unroll and vectorize the copies.
+ * The most frequent values are specialized first, until the instructions
+ * added would exceed the budget.
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#include "llvm/Transforms/Utils/SeminalSpecializer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/SeminalInstrumenter.h"
+#include "llvm/Transforms/Utils/SeminalLibraryCatalog.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+
+using namespace llvm;
+
+static cl::opt<std::string> ValueProfile(
+    "seminal-value-profile", cl::init(""), cl::value_desc("file"),
+    cl::desc("Feature snapshots of profiled runs, one `name value [count]` "
+             "line each"));
+
+static cl::opt<double> HotShare(
+    "seminal-hot-share", cl::init(0.25),
+    cl::desc("Share of the profiled runs a feature value must occur in to "
+             "be specialized for"));
+
+static cl::opt<unsigned> MaxHotValues(
+    "seminal-max-hot-values", cl::init(2),
+    cl::desc("Most values specialized for per feature"));
+
+static cl::opt<unsigned> SpecializeBudget(
+    "seminal-specialize-budget", cl::init(1000),
+    cl::desc("Most instructions the specializer may add to the module"));
+
+namespace {
+
+/** A value a feature takes in a large share of the profiled runs. */
+struct HotValue {
+  std::string feature;
+  int64_t value;
+  double share;
+};
+
+/** Where a feature is kept. */
+struct FeatureStorage {
+  Value *storage;
+  uint64_t offset;
+};
+
+} // namespace
+
+// ---- HELPER FUNCTIONS ----
+
+/**
+ * Reads the hot values of a value profile: concatenated snapshots, each line
+ * a feature name, a value and an optional count. Lengths (`len(fp)`) bound
+ * loops through their input, not through a value, and are skipped.
+ *
+ * @param path The value profile.
+ * @param hotValues Receives the hot values, most frequent first.
+ * @return False if the profile cannot be read.
+ */
+static bool readProfile(const std::string &path,
+                        std::vector<HotValue> *hotValues) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+
+  std::map<std::string, std::map<double, uint64_t>> counts;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string name;
+    double value = 0;
+    uint64_t count = 1;
+    if (!(fields >> name >> value) || name == "cpu_ns" ||
+        name.compare(0, 4, "len(") == 0) {
+      continue;
+    }
+    fields >> count;
+    counts[name][value] += count;
+  }
+
+  for (auto &feature : counts) {
+    uint64_t total = 0;
+    for (auto &entry : feature.second) {
+      total += entry.second;
+    }
+
+    std::vector<HotValue> values;
+    for (auto &entry : feature.second) {
+      double share = double(entry.second) / total;
+      if (share >= HotShare && std::trunc(entry.first) == entry.first) {
+        values.push_back({feature.first, int64_t(entry.first), share});
+      }
+    }
+    std::sort(values.begin(), values.end(),
+              [](const HotValue &a, const HotValue &b) {
+                return a.share > b.share;
+              });
+    if (values.size() > MaxHotValues) {
+      values.resize(MaxHotValues);
+    }
+    hotValues->insert(hotValues->end(), values.begin(), values.end());
+  }
+
+  std::stable_sort(hotValues->begin(), hotValues->end(),
+                   [](const HotValue &a, const HotValue &b) {
+                     return a.share > b.share;
+                   });
+  return true;
+}
+
+/**
+ * Returns the integer a value loads from the feature, looking through
+ * integer casts, or null.
+ *
+ * @param value The value to inspect.
+ * @param feature Where the feature is kept.
+ * @param DL The module's data layout.
+ */
+static LoadInst *getFeatureLoad(Value *value, const FeatureStorage &feature,
+                                const DataLayout &DL) {
+  while (CastInst *cast = dyn_cast<CastInst>(value)) {
+    if (!cast->getType()->isIntegerTy()) {
+      break;
+    }
+    value = cast->getOperand(0);
+  }
+  LoadInst *load = dyn_cast<LoadInst>(value);
+  if (!load || !load->getType()->isIntegerTy()) {
+    return nullptr;
+  }
+  int64_t offset = 0;
+  Value *base =
+      GetPointerBaseWithConstantOffset(load->getPointerOperand(), offset, DL);
+  return base == feature.storage && uint64_t(offset) == feature.offset
+             ? load
+             : nullptr;
+}
+
+/**
+ * Returns true if an instruction may change the feature.
+ *
+ * @param inst The instruction.
+ * @param feature Where the feature is kept.
+ */
+static bool mayWriteFeature(Instruction *inst, const FeatureStorage &feature) {
+  auto addresses = [&feature](const Value *pointer) {
+    const Value *object = getUnderlyingObject(pointer);
+    return object == feature.storage || !isIdentifiedObject(object);
+  };
+
+  if (StoreInst *store = dyn_cast<StoreInst>(inst)) {
+    return addresses(store->getPointerOperand());
+  }
+  CallBase *call = dyn_cast<CallBase>(inst);
+  if (!call || !call->mayWriteToMemory() ||
+      (isa<IntrinsicInst>(call) && !isa<MemIntrinsic>(call))) {
+    return false;
+  }
+
+  const SeminalLibraryModel *model = SeminalLibraryCatalog::get().lookup(call);
+  if (model && !model->writesMemory()) {
+    return false;
+  }
+  Function *callee = call->getCalledFunction();
+  if (isa<GlobalVariable>(feature.storage) &&
+      (!callee || !callee->isDeclaration())) {
+    return true;
+  }
+  for (Value *arg : call->args()) {
+    if (arg->getType()->isPointerTy() && addresses(arg)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Returns true if a loop should be versioned for a feature: it reads the
+ * feature, never writes it, an exit of the loop (or of a loop inside it)
+ * depends on what it reads, and no value it computes is used after it.
+ *
+ * @param loop The loop.
+ * @param LI The LoopInfo of its function.
+ * @param feature Where the feature is kept.
+ * @param DL The module's data layout.
+ */
+static bool isAffectedLoop(Loop *loop, LoopInfo &LI,
+                           const FeatureStorage &feature,
+                           const DataLayout &DL) {
+  std::vector<Instruction *> worklist;
+  for (BasicBlock *block : loop->blocks()) {
+    for (Instruction &inst : *block) {
+      if (mayWriteFeature(&inst, feature)) {
+        return false;
+      }
+      for (User *user : inst.users()) {
+        Instruction *userInst = dyn_cast<Instruction>(user);
+        if (userInst && !loop->contains(userInst)) {
+          return false;
+        }
+      }
+      if (getFeatureLoad(&inst, feature, DL) == &inst) {
+        worklist.push_back(&inst);
+      }
+    }
+  }
+
+  std::set<Instruction *> reached(worklist.begin(), worklist.end());
+  while (!worklist.empty()) {
+    Instruction *inst = worklist.back();
+    worklist.pop_back();
+    BranchInst *branch = dyn_cast<BranchInst>(inst);
+    if (branch && LI.getLoopFor(branch->getParent())
+                      ->isLoopExiting(branch->getParent())) {
+      return true;
+    }
+    for (User *user : inst->users()) {
+      Instruction *userInst = dyn_cast<Instruction>(user);
+      if (userInst && loop->contains(userInst) &&
+          reached.insert(userInst).second) {
+        worklist.push_back(userInst);
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * Creates `feature == value` before an instruction.
+ *
+ * @param builder The builder positioned at the guard.
+ * @param type The integer type the feature is read as.
+ * @param feature Where the feature is kept.
+ * @param value The hot value.
+ */
+static Value *createGuard(IRBuilder<> &builder, Type *type,
+                          const FeatureStorage &feature, int64_t value) {
+  Value *address =
+      builder.CreatePointerCast(feature.storage, builder.getInt8PtrTy());
+  if (feature.offset) {
+    address = builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(), address,
+                                                 feature.offset);
+  }
+  address = builder.CreatePointerCast(address, PointerType::getUnqual(type));
+  return builder.CreateICmpEQ(builder.CreateLoad(type, address),
+                              ConstantInt::get(type, value, true),
+                              "seminal.hot");
+}
+
+/**
+ * Returns branch weights favoring the specialized copy by its share of the
+ * profiled runs.
+ *
+ * @param context The module's context.
+ * @param share The share of runs taking the hot value.
+ */
+static MDNode *getGuardWeights(LLVMContext &context, double share) {
+  uint32_t hot = uint32_t(share * 1000) + 1;
+  return MDBuilder(context).createBranchWeights(hot, 1001 - hot + 1);
+}
+
+/**
+ * Versions a loop for a hot value: a copy of the loop, entered when the
+ * feature has the value, reads it as a constant.
+ *
+ * @param loop The loop to version, with a preheader and dedicated exits.
+ * @param LI The LoopInfo of its function.
+ * @param DT The dominator tree of its function.
+ * @param feature Where the feature is kept.
+ * @param hot The hot value.
+ * @param DL The module's data layout.
+ */
+static void versionLoop(Loop *loop, LoopInfo &LI, DominatorTree &DT,
+                        const FeatureStorage &feature, const HotValue &hot,
+                        const DataLayout &DL) {
+  BasicBlock *guard = loop->getLoopPreheader();
+  BasicBlock *preheader = SplitEdge(guard, loop->getHeader(), &DT, &LI);
+
+  ValueToValueMapTy VMap;
+  SmallVector<BasicBlock *, 8> blocks;
+  Loop *copy = cloneLoopWithPreheader(preheader, guard, loop, VMap,
+                                      ".seminal." + Twine(hot.value), &LI,
+                                      &DT, blocks);
+  remapInstructionsInBlocks(blocks, VMap);
+
+  // The exits are now also reached from the copy
+  SmallVector<BasicBlock *, 4> exits;
+  loop->getUniqueExitBlocks(exits);
+  for (BasicBlock *exit : exits) {
+    for (PHINode &phi : exit->phis()) {
+      for (unsigned i = 0, e = phi.getNumIncomingValues(); i < e; ++i) {
+        BasicBlock *incoming = phi.getIncomingBlock(i);
+        if (!loop->contains(incoming)) {
+          continue;
+        }
+        Value *value = phi.getIncomingValue(i);
+        auto mapped = VMap.find(value);
+        if (mapped != VMap.end()) {
+          value = mapped->second;
+        }
+        phi.addIncoming(value, cast<BasicBlock>(VMap[incoming]));
+      }
+    }
+  }
+
+  Type *type = nullptr;
+  for (BasicBlock *block : copy->blocks()) {
+    for (Instruction &inst : make_early_inc_range(*block)) {
+      if (getFeatureLoad(&inst, feature, DL) == &inst) {
+        type = inst.getType();
+        inst.replaceAllUsesWith(ConstantInt::get(type, hot.value, true));
+        inst.eraseFromParent();
+      }
+    }
+  }
+
+  Instruction *terminator = guard->getTerminator();
+  IRBuilder<> builder(terminator);
+  Value *isHot = createGuard(builder, type, feature, hot.value);
+  builder.CreateCondBr(isHot, copy->getLoopPreheader(), preheader,
+                       getGuardWeights(guard->getContext(), hot.share));
+  terminator->eraseFromParent();
+}
+
+/**
+ * Returns the number of instructions in a loop.
+ *
+ * @param loop The loop.
+ */
+static unsigned getLoopSize(Loop *loop) {
+  unsigned size = 0;
+  for (BasicBlock *block : loop->blocks()) {
+    size += block->size();
+  }
+  return size;
+}
+
+/**
+ * Lets later passes optimize a function that was compiled at -O0.
+ *
+ * @param F The function.
+ */
+static void allowOptimization(Function *F) {
+  F->removeFnAttr(Attribute::OptimizeNone);
+  F->removeFnAttr(Attribute::NoInline);
+}
+
+/**
+ * Versions the loops of a function that depend on a feature, outermost
+ * loops first, within the budget.
+ *
+ * @param F The function.
+ * @param FAM The function analysis manager.
+ * @param feature Where the feature is kept.
+ * @param hot The hot value.
+ * @param budget The instructions that may still be added; reduced.
+ * @return The number of loops versioned.
+ */
+static unsigned versionLoops(Function &F, FunctionAnalysisManager &FAM,
+                             const FeatureStorage &feature,
+                             const HotValue &hot, unsigned *budget) {
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  std::vector<BasicBlock *> headers;
+  {
+    LoopInfo &LI = FAM.getResult<LoopAnalysis>(F);
+    std::vector<Loop *> worklist(LI.begin(), LI.end());
+    while (!worklist.empty()) {
+      Loop *loop = worklist.back();
+      worklist.pop_back();
+      if (isAffectedLoop(loop, LI, feature, DL)) {
+        headers.push_back(loop->getHeader());
+      } else {
+        worklist.insert(worklist.end(), loop->begin(), loop->end());
+      }
+    }
+  }
+
+  unsigned versioned = 0;
+  for (BasicBlock *header : headers) {
+    LoopInfo &LI = FAM.getResult<LoopAnalysis>(F);
+    DominatorTree &DT = FAM.getResult<DominatorTreeAnalysis>(F);
+    Loop *loop = LI.getLoopFor(header);
+    if (!loop || loop->getHeader() != header || !loop->getLoopPreheader() ||
+        !loop->hasDedicatedExits() || getLoopSize(loop) > *budget) {
+      continue;
+    }
+
+    *budget -= getLoopSize(loop);
+    versionLoop(loop, LI, DT, feature, hot, DL);
+    FAM.invalidate(F, PreservedAnalyses::none());
+    ++versioned;
+  }
+  if (versioned) {
+    allowOptimization(&F);
+  }
+  return versioned;
+}
+
+/**
+ * Clones the functions that receive a feature as an argument: each call is
+ * guarded by `argument == value` and calls, in that case, a clone of the
+ * callee whose parameter is the constant.
+ *
+ * @param M The module.
+ * @param feature Where the feature is kept.
+ * @param hot The hot value.
+ * @param budget The instructions that may still be added; reduced.
+ * @param fastCalls The calls to clones made so far, which are never
+ * specialized again; extended.
+ * @return The number of calls specialized.
+ */
+static unsigned specializeCalls(Module &M, const FeatureStorage &feature,
+                                const HotValue &hot, unsigned *budget,
+                                std::set<CallInst *> *fastCalls) {
+  const DataLayout &DL = M.getDataLayout();
+  std::vector<std::pair<CallInst *, unsigned>> calls;
+  for (Function &F : M) {
+    for (Instruction &inst : instructions(F)) {
+      CallInst *call = dyn_cast<CallInst>(&inst);
+      Function *callee = call ? call->getCalledFunction() : nullptr;
+      if (!callee || callee->isDeclaration() || callee->isVarArg() ||
+          fastCalls->count(call)) {
+        continue;
+      }
+      for (unsigned i = 0; i < call->arg_size(); ++i) {
+        Value *arg = call->getArgOperand(i);
+        if (arg->getType()->isIntegerTy() &&
+            ConstantInt::isValueValidForType(arg->getType(), hot.value) &&
+            getFeatureLoad(arg, feature, DL)) {
+          calls.push_back({call, i});
+          break;
+        }
+      }
+    }
+  }
+
+  std::map<std::pair<Function *, unsigned>, Function *> clones;
+  unsigned specialized = 0;
+  for (auto &entry : calls) {
+    CallInst *call = entry.first;
+    unsigned index = entry.second;
+    Function *callee = call->getCalledFunction();
+    Type *type = call->getArgOperand(index)->getType();
+
+    Function *&clone = clones[{callee, index}];
+    if (!clone) {
+      unsigned size = callee->getInstructionCount();
+      if (size > *budget) {
+        continue;
+      }
+      *budget -= size;
+      ValueToValueMapTy VMap;
+      clone = CloneFunction(callee, VMap);
+      clone->setName(callee->getName() + ".seminal." + Twine(hot.value));
+      clone->setLinkage(GlobalValue::InternalLinkage);
+      clone->getArg(index)->replaceAllUsesWith(
+          ConstantInt::get(type, hot.value, true));
+      allowOptimization(clone);
+    }
+
+    IRBuilder<> builder(call);
+    Value *isHot = builder.CreateICmpEQ(call->getArgOperand(index),
+                                        ConstantInt::get(type, hot.value, true),
+                                        "seminal.hot");
+    Instruction *thenTerm = nullptr;
+    Instruction *elseTerm = nullptr;
+    SplitBlockAndInsertIfThenElse(
+        isHot, call, &thenTerm, &elseTerm,
+        getGuardWeights(M.getContext(), hot.share));
+
+    CallInst *fast = cast<CallInst>(call->clone());
+    fast->setCalledFunction(clone);
+    fast->insertBefore(thenTerm);
+    fastCalls->insert(fast);
+    BasicBlock *tail = call->getParent();
+    call->moveBefore(elseTerm);
+    if (!call->getType()->isVoidTy()) {
+      PHINode *result = PHINode::Create(call->getType(), 2, "", &tail->front());
+      call->replaceAllUsesWith(result);
+      result->addIncoming(fast, fast->getParent());
+      result->addIncoming(call, call->getParent());
+    }
+    ++specialized;
+  }
+  return specialized;
+}
+
+// ---- END HELPER FUNCTIONS ----
+
+// ---- PASS DEFINITION ----
+
+/**
+ * Executes the Seminal Specializer pass on a module.
+ *
+ * @param M The module to specialize.
+ * @param MAM The module analysis manager providing the function analyses.
+ * @return The preserved analyses after the pass runs.
+ */
+PreservedAnalyses SeminalSpecializerPass::run(Module &M,
+                                              ModuleAnalysisManager &MAM) {
+  std::vector<HotValue> hotValues;
+  if (!readProfile(ValueProfile, &hotValues)) {
+    llvm::errs() << "Error: Could not read value profile from "
+                 << ValueProfile << ".\n";
+    return PreservedAnalyses::all();
+  }
+
+  FunctionAnalysisManager &FAM =
+      MAM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  std::vector<Function *> functions;
+  for (Function &F : M) {
+    if (!F.isDeclaration()) {
+      functions.push_back(&F);
+    }
+  }
+
+  unsigned budget = SpecializeBudget;
+  std::set<CallInst *> fastCalls;
+  bool changed = false;
+  for (const HotValue &hot : hotValues) {
+    FeatureStorage feature;
+    DIType *type = nullptr;
+    feature.storage =
+        findFeatureStorage(M, hot.feature, 0, &feature.offset, &type);
+    if (!feature.storage) {
+      llvm::errs() << "Warning: No storage found for seminal feature "
+                   << hot.feature << ".\n";
+      continue;
+    }
+
+    unsigned loops = 0;
+    for (Function *F : functions) {
+      loops += versionLoops(*F, FAM, feature, hot, &budget);
+    }
+    unsigned calls = specializeCalls(M, feature, hot, &budget, &fastCalls);
+    if (loops || calls) {
+      llvm::errs() << "Specialized " << hot.feature << " == " << hot.value
+                   << ": " << loops << " loop(s), " << calls
+                   << " call(s).\n";
+      changed = true;
+    }
+  }
+
+  return changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
+// ---- END PASS DEFINITION ----
@@ -0,0 +1,31 @@
+#!/bin/bash -eu
+
+# Colors for output
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+TOOLS_DIR="../tools"
+TRACE="${1:-branch-pointer_trace.txt}"
+DICTIONARY="${DICTIONARY:-branch-dictionary.txt}"
+
+# Threads scanning the trace; defaults to one per core
+THREADS="${THREADS:-$(nproc)}"
+
+if [ ! -f "$TRACE" ]; then
+    echo -e "${RED}✗ Trace $TRACE not found${NC}"
+    echo -e "${RED}Usage: $0 [branch-pointer_trace.txt]${NC}"
+    exit 1
+fi
+
+echo "=== Building fpl-aggregate ==="
+if [ ! -x fpl-aggregate ] || [ "$TOOLS_DIR/fpl_aggregate.cpp" -nt fpl-aggregate ] ||
+   [ "$TOOLS_DIR/fpl_trace.h" -nt fpl-aggregate ]; then
+    clang++ -std=c++17 -O2 -pthread "$TOOLS_DIR/fpl_aggregate.cpp" \
+            -I"$TOOLS_DIR" -o fpl-aggregate
+fi
+
+echo "=== Aggregating $TRACE ==="
+./fpl-aggregate -j "$THREADS" -d "$DICTIONARY" -o branch-hotness.txt "$TRACE"
+
+echo -e "${GREEN}✓ Wrote branch-hotness.txt${NC}"
@@ -0,0 +1,81 @@
+#!/bin/bash -eu
+set -o pipefail
+
+# Colors for output
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+# Check if test file, feature and sizes are provided
+if [ $# -lt 3 ]; then
+    echo -e "${RED}Usage: $0 <test_file_without_extension> <feature> <size>...${NC}"
+    echo -e "${RED}  INPUT_CMD='echo 1, {}'      command whose output is the program's stdin${NC}"
+    echo -e "${RED}  INPUT_FILE=../tests/words.txt  file of {} bytes the program reads${NC}"
+    exit 1
+fi
+
+TEST_NAME="$1"
+FEATURE="$2"
+shift 2
+SIZES="$*"
+TOOLS_DIR="../tools"
+
+# How each run gets its input; {} is replaced by the size
+INPUT_CMD="${INPUT_CMD:-}"
+INPUT_FILE="${INPUT_FILE:-}"
+
+# Runs per size, runs at once, and seconds before a run is stopped
+REPEATS="${REPEATS:-3}"
+JOBS="${JOBS:-$(nproc)}"
+RUN_TIMEOUT="${RUN_TIMEOUT:-60}"
+
+if [ -z "$INPUT_CMD" ] && [ -z "$INPUT_FILE" ]; then
+    echo -e "${RED}✗ Set INPUT_CMD or INPUT_FILE to generate the inputs${NC}"
+    exit 1
+fi
+
+WORK_DIR="fit-$TEST_NAME"
+DATASET="$PWD/$WORK_DIR/dataset.bin"
+rm -rf "$WORK_DIR"
+mkdir -p "$WORK_DIR"
+
+echo "=== Building Instrumented Program ==="
+DATASET="$DATASET" ./llvm_instrument.sh "$TEST_NAME" > /dev/null
+
+echo "=== Running $REPEATS x {$SIZES} on $JOBS cores ==="
+run_one() {
+    local size="$1" repeat="$2"
+    local dir="$WORK_DIR/run-$size-$repeat/cwd"
+    mkdir -p "$dir"
+    if [ -n "$INPUT_FILE" ]; then
+        mkdir -p "$(dirname "$dir/$INPUT_FILE")"
+        head -c "$size" /dev/urandom | base64 -w 60 | head -c "$size" \
+            > "$dir/$INPUT_FILE"
+    fi
+    local input="/dev/null"
+    if [ -n "$INPUT_CMD" ]; then
+        input="$PWD/$dir/../stdin.txt"
+        bash -c "${INPUT_CMD//\{\}/$size}" > "$input"
+    fi
+    (cd "$dir" && SEMINAL_SNAPSHOT=snapshot.txt SEMINAL_DATASET="$DATASET" \
+        timeout "$RUN_TIMEOUT" \
+        "$OLDPWD/${TEST_NAME}_snapshot" < "$input" > /dev/null 2>&1) ||
+        echo "Warning: run with size $size exited with $?"
+}
+export -f run_one
+export WORK_DIR DATASET INPUT_CMD INPUT_FILE RUN_TIMEOUT TEST_NAME
+for size in $SIZES; do
+    for repeat in $(seq "$REPEATS"); do
+        echo "$size $repeat"
+    done
+done | xargs -P "$JOBS" -n 2 bash -c 'run_one "$0" "$1"'
+
+echo "=== Fitting Against $FEATURE ==="
+if [ ! -x seminal-fit ] || [ "$TOOLS_DIR/seminal_fit.cpp" -nt seminal-fit ]; then
+    clang++ -std=c++17 -O2 "$TOOLS_DIR/seminal_fit.cpp" -I"$TOOLS_DIR" \
+            -o seminal-fit
+fi
+./seminal-fit -j seminal-values.json "$DATASET" "$FEATURE" \
+    | tee "$WORK_DIR/complexity.txt"
+
+echo -e "${GREEN}✓ Report written to $WORK_DIR/complexity.txt${NC}"
@@ -0,0 +1,76 @@
+#!/bin/bash -eu
+
+# Colors for output
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+# Check if test file argument is provided
+if [ $# -lt 1 ]; then
+    echo -e "${RED}Usage: $0 <test_file_without_extension>${NC}"
+    exit 1
+fi
+
+TEST_FILE="../tests/$1.c"
+RUNTIME_DIR="../runtime"
+
+# Where the instrumented program publishes its snapshot; set SNAPSHOT_SHM=1
+# to publish it in POSIX shared memory under that name instead
+SNAPSHOT_PATH="${SNAPSHOT_PATH:-seminal-snapshot.txt}"
+SNAPSHOT_SHM="${SNAPSHOT_SHM:-0}"
+SHM_FLAG=""
+if [ "$SNAPSHOT_SHM" = "1" ]; then
+    SHM_FLAG="-seminal-snapshot-shm"
+fi
+
+# Set INPUT_LOG to also log the values every scanf, fscanf and sscanf parses
+INPUT_LOG="${INPUT_LOG:-}"
+WRAP_FLAGS=""
+if [ -n "$INPUT_LOG" ]; then
+    WRAP_FLAGS="-seminal-wrap-input -seminal-input-log=$INPUT_LOG"
+fi
+
+# Set IO_SUMMARY to also count the bytes, calls and time of each stream read
+IO_SUMMARY="${IO_SUMMARY:-}"
+if [ -n "$IO_SUMMARY" ]; then
+    WRAP_FLAGS="$WRAP_FLAGS -seminal-count-input -seminal-io-summary=$IO_SUMMARY"
+fi
+
+# Set DATASET to append one record per run, with loop and branch counts
+if [ -n "${DATASET:-}" ]; then
+    WRAP_FLAGS="$WRAP_FLAGS -seminal-dataset=$DATASET"
+fi
+
+# Set TRACK_BUFFERS=1 to snapshot the highest index written to input buffers
+if [ "${TRACK_BUFFERS:-0}" = "1" ]; then
+    WRAP_FLAGS="$WRAP_FLAGS -seminal-track-buffers"
+fi
+
+echo "=== Compiling Test Program ==="
+# Snapshots are located through debug info, so the program is built with -g
+clang -g -O0 -emit-llvm -c "$TEST_FILE" -o $1.bc
+
+echo "=== Detecting Seminal Features ==="
+opt -passes=seminal-input-detector -disable-output $1.bc
+
+if [ ! -f seminal-values.json ]; then
+    echo -e "${RED}✗ Feature file seminal-values.json not found${NC}"
+    exit 1
+fi
+
+echo "=== Instrumenting Test Program ==="
+opt -passes=seminal-instrument -seminal-features=seminal-values.json \
+    -seminal-snapshot-path="$SNAPSHOT_PATH" $SHM_FLAG $WRAP_FLAGS $1.bc -o instrumented.bc
+
+echo "=== Linking Snapshot Runtime ==="
+clang -g instrumented.bc "$RUNTIME_DIR/seminal_runtime.c" -I"$RUNTIME_DIR" \
+      -lrt -o $1_snapshot
+
+echo -e "${GREEN}✓ Built $1_snapshot${NC}"
+echo "Run it; the feature snapshot is published to $SNAPSHOT_PATH as soon as"
+echo "the seminal inputs have been read."
+
+# Cleanup
+rm -f $1.bc instrumented.bc
+
+echo -e "\n=== Instrumentation Complete ==="
@@ -0,0 +1,22 @@
+#!/bin/bash -eu
+
+# Colors for output
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+TOOLS_DIR="../tools"
+TRACE="${TRACE:-branch-pointer_trace.txt}"
+
+if [ ! -f "$TRACE" ]; then
+    echo -e "${RED}✗ Trace $TRACE not found${NC}"
+    echo -e "${RED}Usage: TRACE=<trace> $0 [-s first-event] [-n events] [-l]${NC}"
+    exit 1
+fi
+
+if [ ! -x fpl-replay ] || [ "$TOOLS_DIR/fpl_replay.cpp" -nt fpl-replay ] ||
+   [ "$TOOLS_DIR/fpl_trace.h" -nt fpl-replay ]; then
+    clang++ -std=c++17 -O2 -pthread "$TOOLS_DIR/fpl_replay.cpp" \
+            -I"$TOOLS_DIR" -o fpl-replay
+fi
+
+./fpl-replay "$@" "$TRACE"
@@ -0,0 +1,32 @@
+#!/bin/bash -eu
+
+# Colors for output
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+TOOLS_DIR="../tools"
+COUNTS="${1:-branch-hotness.txt}"
+REPORT_DIR="${REPORT_DIR:-report}"
+DICTIONARY="${DICTIONARY:-branch-dictionary.txt}"
+
+# Where relative source names in the dictionary are resolved
+SOURCE_DIR="${SOURCE_DIR:-.}"
+
+if [ ! -f "$COUNTS" ]; then
+    echo -e "${RED}✗ Branch counts $COUNTS not found; run llvm_aggregate.sh first${NC}"
+    exit 1
+fi
+
+echo "=== Building fpl-report ==="
+if [ ! -x fpl-report ] || [ "$TOOLS_DIR/fpl_report.cpp" -nt fpl-report ]; then
+    clang++ -std=c++17 -O2 "$TOOLS_DIR/fpl_report.cpp" -I"$TOOLS_DIR" \
+            -o fpl-report
+fi
+
+echo "=== Annotating Sources ==="
+mkdir -p "$REPORT_DIR"
+./fpl-report -c "$COUNTS" -d "$DICTIONARY" -j seminal-values.json -S "$SOURCE_DIR" \
+             -o "$REPORT_DIR"
+
+echo -e "${GREEN}✓ Reports written to $REPORT_DIR${NC}"
@@ -0,0 +1,53 @@
+#!/bin/bash -eu
+
+# Colors for output
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+# Check if test file argument is provided
+if [ $# -lt 1 ]; then
+    echo -e "${RED}Usage: $0 <test_file_without_extension>${NC}"
+    exit 1
+fi
+
+TEST_FILE="../tests/$1.c"
+RUNTIME_DIR="../runtime"
+
+# Where the instrumented program publishes its snapshot; set SNAPSHOT_SHM=1
+# to publish it in POSIX shared memory under that name instead
+SNAPSHOT_PATH="${SNAPSHOT_PATH:-seminal-snapshot.txt}"
+SNAPSHOT_SHM="${SNAPSHOT_SHM:-0}"
+SHM_FLAG=""
+if [ "$SNAPSHOT_SHM" = "1" ]; then
+    SHM_FLAG="-seminal-snapshot-shm"
+fi
+
+echo "=== Compiling Test Program ==="
+# Snapshots are located through debug info, so the program is built with -g
+clang -g -O0 -emit-llvm -c "$TEST_FILE" -o $1.bc
+
+echo "=== Detecting Seminal Features ==="
+opt -passes=seminal-input-detector -disable-output $1.bc
+
+if [ ! -f seminal-values.json ]; then
+    echo -e "${RED}✗ Feature file seminal-values.json not found${NC}"
+    exit 1
+fi
+
+echo "=== Slicing Feature Extractor ==="
+opt -passes=seminal-instrument,seminal-slice -seminal-features=seminal-values.json \
+    -seminal-snapshot-path="$SNAPSHOT_PATH" $SHM_FLAG $1.bc -o instrumented.bc
+
+echo "=== Linking Snapshot Runtime ==="
+clang -O2 -g instrumented.bc "$RUNTIME_DIR/seminal_runtime.c" -I"$RUNTIME_DIR" \
+      -lrt -o $1_features
+
+echo -e "${GREEN}✓ Built $1_features${NC}"
+echo "Feed it the job's input; it prints the feature vector and exits as soon"
+echo "as the seminal inputs have been read, without doing the program's work."
+
+# Cleanup
+rm -f $1.bc instrumented.bc
+
+echo -e "\n=== Slicing Complete ==="
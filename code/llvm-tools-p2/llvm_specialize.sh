@@ -0,0 +1,42 @@
+#!/bin/bash -eu
+
+# Colors for output
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+# Check if test file and value profile arguments are provided
+if [ $# -lt 2 ]; then
+    echo -e "${RED}Usage: $0 <test_file_without_extension> <value_profile>${NC}"
+    exit 1
+fi
+
+TEST_FILE="../tests/$1.c"
+VALUE_PROFILE="$2"
+
+# Instructions the specializer may add; lower it to limit code growth
+SPECIALIZE_BUDGET="${SPECIALIZE_BUDGET:-1000}"
+
+if [ ! -f "$VALUE_PROFILE" ]; then
+    echo -e "${RED}✗ Value profile $VALUE_PROFILE not found${NC}"
+    exit 1
+fi
+
+echo "=== Compiling Test Program ==="
+# Features are located through debug info; optnone is left off so the
+# specialized copies can be optimized afterwards
+clang -g -O0 -Xclang -disable-O0-optnone -emit-llvm -c "$TEST_FILE" -o $1.bc
+
+echo "=== Specializing Hot Input Values ==="
+opt -passes=seminal-specialize -seminal-value-profile="$VALUE_PROFILE" \
+    -seminal-specialize-budget="$SPECIALIZE_BUDGET" $1.bc -o specialized.bc
+
+echo "=== Optimizing ==="
+clang -O2 -g specialized.bc -o $1_specialized
+
+echo -e "${GREEN}✓ Built $1_specialized${NC}"
+
+# Cleanup
+rm -f $1.bc specialized.bc
+
+echo -e "\n=== Specialization Complete ==="
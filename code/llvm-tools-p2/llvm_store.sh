@@ -0,0 +1,21 @@
+#!/bin/bash -eu
+
+# Colors for output
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+TOOLS_DIR="../tools"
+
+if [ $# -lt 1 ]; then
+    echo -e "${RED}Usage: $0 build -o <store> <dataset>...${NC}"
+    echo -e "${RED}       $0 columns|query|corr <store> ...${NC}"
+    exit 1
+fi
+
+if [ ! -x seminal-store ] || [ "$TOOLS_DIR/seminal_store.cpp" -nt seminal-store ] ||
+   [ "$TOOLS_DIR/fpl_trace.h" -nt seminal-store ]; then
+    clang++ -std=c++17 -O2 "$TOOLS_DIR/seminal_store.cpp" -I"$TOOLS_DIR" \
+            -o seminal-store
+fi
+
+./seminal-store "$@"
@@ -13,9 +13,12 @@ fi
 
 TEST_FILE="../tests/$1.c"
 
+# Optimization level of the analyzed IR; e.g. OPT_LEVEL=-O1 analyzes SSA form
+OPT_LEVEL="${OPT_LEVEL:--O0}"
+
 echo "=== Building LLVM Pass ==="
 # Compile the test program to LLVM IR
-clang  -g -O0 -emit-llvm -c "$TEST_FILE" -o $1.bc -DLLVM_USE_LINKER=lld
+clang  -g $OPT_LEVEL -emit-llvm -c "$TEST_FILE" -o $1.bc -DLLVM_USE_LINKER=lld
 
 echo "=== Running Pass on Test Program ==="
 # Run the pass
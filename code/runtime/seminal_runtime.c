@@ -0,0 +1,782 @@
+/**
+ * Runtime for programs instrumented by the Seminal Instrumenter.
+ *
+ * @file seminal_runtime.c
+ * @brief Keeps the latest value of each recorded feature and publishes the
+ * whole vector on every flush. A file snapshot is written to a temporary
+ * file and renamed over the target, so readers never see a partial one. A
+ * shared memory snapshot is guarded by a sequence counter that is odd while
+ * it is being written; readers retry until they read the same even value
+ * before and after copying the text.
+ *
+ * The input wrappers parse each call site's format string once, on its first
+ * call, and keep the conversions it assigns; later calls only read the values
+ * through the argument pointers and append a call record to a buffer that is
+ * written out when it fills and at exit.
+ *
+ * The stream read wrappers keep their counters in a small open-addressed
+ * table keyed by the FILE * or file descriptor, so each read costs a hash
+ * probe and two clock reads.
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "seminal_runtime.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#define SEMINAL_MAX_FEATURES 64
+#define SEMINAL_SHM_SIZE 4096
+#define SEMINAL_MAX_CONVERSIONS 32
+#define SEMINAL_INPUT_BUFFER 65536
+#define SEMINAL_MAX_HANDLES 64
+
+/** The layout of a shared memory snapshot. */
+struct seminal_shared_snapshot {
+  volatile unsigned long sequence;
+  unsigned long length;
+  char text[SEMINAL_SHM_SIZE - 2 * sizeof(unsigned long)];
+};
+
+static struct {
+  const char *name;
+  double value;
+} features[SEMINAL_MAX_FEATURES];
+static unsigned featureCount;
+
+static const char *target = "seminal-snapshot.txt";
+static int shared;
+static struct seminal_shared_snapshot *snapshot;
+
+/** The length modifier of a scanf conversion. */
+enum seminal_input_size {
+  SIZE_INT,
+  SIZE_CHAR,        // hh
+  SIZE_SHORT,       // h
+  SIZE_LONG,        // l
+  SIZE_LONG_LONG,   // ll, q
+  SIZE_INTMAX,      // j
+  SIZE_SIZE,        // z
+  SIZE_PTRDIFF,     // t
+  SIZE_LONG_DOUBLE  // L
+};
+
+/**
+ * The conversions of a format string that take an argument. A kind of 0 is a
+ * %n, which takes one but does not count towards scanf's return value. An
+ * allocated conversion (m) is handed a pointer to the malloc'ed buffer. The
+ * width of a %c is the number of characters it stores (1 unless a field
+ * width is given); that of a %s or %[ is 0, as their length is measured.
+ */
+struct seminal_input_site {
+  int parsed;
+  unsigned char count;
+  unsigned char kind[SEMINAL_MAX_CONVERSIONS];
+  unsigned char size[SEMINAL_MAX_CONVERSIONS];
+  unsigned char allocated[SEMINAL_MAX_CONVERSIONS];
+  unsigned width[SEMINAL_MAX_CONVERSIONS];
+};
+
+static struct seminal_input_site *inputSites;
+static unsigned inputSiteCount;
+static int inputLog = -1;
+static unsigned char inputBuffer[SEMINAL_INPUT_BUFFER];
+static size_t inputLength;
+
+/** The reads of one stream or file descriptor. */
+struct seminal_io_handle {
+  uintptr_t key; // The FILE *, or the descriptor + 1 tagged by the low bit
+  int fd;
+  unsigned long long bytes;
+  unsigned long long calls;
+  unsigned long long nanoseconds;
+};
+
+static struct seminal_io_handle ioHandles[SEMINAL_MAX_HANDLES];
+static const char *ioSummary;
+
+static struct {
+  const char *name;
+  unsigned line;
+  const long long *mark;
+} bufferMarks[SEMINAL_MAX_FEATURES];
+static unsigned bufferMarkCount;
+
+static struct {
+  const char *path;
+  const char *const *features;
+  unsigned featureCount;
+  const long long *counters;
+  unsigned counterCount;
+  unsigned long long start;
+} dataset;
+
+// ---- HELPER FUNCTIONS ----
+
+/**
+ * Returns the CPU time the process has used so far, in nanoseconds.
+ */
+static long long cpuNanoseconds(void) {
+  struct timespec now;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) != 0) {
+    return -1;
+  }
+  return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Formats the recorded features, one `name value` line each, after a line
+ * with the CPU time at which the snapshot was taken.
+ *
+ * @param text The buffer to fill.
+ * @param size The size of the buffer.
+ * @return The length of the text.
+ */
+static size_t formatSnapshot(char *text, size_t size) {
+  int length = snprintf(text, size, "cpu_ns %lld\n", cpuNanoseconds());
+  for (unsigned i = 0; i < featureCount && length >= 0 &&
+                       (size_t)length < size;
+       ++i) {
+    length += snprintf(text + length, size - length, "%s %.17g\n",
+                       features[i].name, features[i].value);
+  }
+  if (length < 0) {
+    return 0;
+  }
+  return (size_t)length < size ? (size_t)length : size - 1;
+}
+
+/**
+ * Maps the shared memory snapshot, creating it if needed.
+ *
+ * @return The snapshot, or NULL if it cannot be mapped.
+ */
+static struct seminal_shared_snapshot *mapSnapshot(void) {
+  int fd = shm_open(target, O_CREAT | O_RDWR, 0644);
+  if (fd < 0) {
+    return NULL;
+  }
+  if (ftruncate(fd, SEMINAL_SHM_SIZE) != 0) {
+    close(fd);
+    return NULL;
+  }
+  void *memory = mmap(NULL, SEMINAL_SHM_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+  close(fd);
+  return memory == MAP_FAILED ? NULL : memory;
+}
+
+/**
+ * Parses the conversions of a scanf format string.
+ *
+ * @param format The format string.
+ * @param site The conversions found, up to SEMINAL_MAX_CONVERSIONS.
+ */
+static void parseFormat(const char *format, struct seminal_input_site *site) {
+  site->count = 0;
+  for (const char *c = format; *c && site->count < SEMINAL_MAX_CONVERSIONS;
+       ++c) {
+    if (*c != '%') {
+      continue;
+    }
+    if (*++c == '%') {
+      continue;
+    }
+    int suppressed = *c == '*';
+    if (suppressed) {
+      ++c;
+    }
+
+    // The width and the allocation flag are accepted in either order
+    unsigned width = 0;
+    int allocated = 0;
+    for (;; ++c) {
+      if (*c >= '0' && *c <= '9') {
+        width = width * 10 + (*c - '0');
+      } else if (*c == 'm') {
+        allocated = 1;
+      } else {
+        break;
+      }
+    }
+
+    enum seminal_input_size size = SIZE_INT;
+    switch (*c) {
+    case 'h':
+      size = *++c == 'h' ? (++c, SIZE_CHAR) : SIZE_SHORT;
+      break;
+    case 'l':
+      size = *++c == 'l' ? (++c, SIZE_LONG_LONG) : SIZE_LONG;
+      break;
+    case 'q':
+      size = SIZE_LONG_LONG, ++c;
+      break;
+    case 'j':
+      size = SIZE_INTMAX, ++c;
+      break;
+    case 'z':
+      size = SIZE_SIZE, ++c;
+      break;
+    case 't':
+      size = SIZE_PTRDIFF, ++c;
+      break;
+    case 'L':
+      size = SIZE_LONG_DOUBLE, ++c;
+      break;
+    }
+
+    unsigned char kind;
+    switch (*c) {
+    case 'd':
+    case 'i':
+      kind = SEMINAL_INPUT_SIGNED;
+      break;
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    case 'p':
+      kind = SEMINAL_INPUT_UNSIGNED;
+      break;
+    case 'a':
+    case 'A':
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+      kind = SEMINAL_INPUT_FLOAT;
+      break;
+    case 'c':
+      kind = allocated ? SEMINAL_INPUT_LENGTH : SEMINAL_INPUT_CHAR;
+      width = width ? width : 1;
+      break;
+    case '[':
+      // Skip the scanset; a leading ']' is part of it
+      c += c[1] == '^' ? 2 : 1;
+      if (*c == ']') {
+        ++c;
+      }
+      while (*c && *c != ']') {
+        ++c;
+      }
+      // Fall through
+    case 's':
+      kind = SEMINAL_INPUT_LENGTH;
+      width = 0;
+      break;
+    case 'n':
+      kind = 0;
+      break;
+    default:
+      return;
+    }
+    if (!*c) {
+      return;
+    }
+    if (!suppressed) {
+      site->kind[site->count] = kind;
+      site->size[site->count] = size;
+      site->allocated[site->count] = allocated;
+      site->width[site->count++] = width;
+    }
+  }
+}
+
+/**
+ * Reads the value a conversion assigned through its argument pointer. With
+ * the l modifier, %s, %[ and %c store wide characters. A %mc buffer holds
+ * exactly the field width and no terminator, so its width is logged.
+ *
+ * @param site The conversions of the call's format.
+ * @param i The conversion.
+ * @param pointer The argument it assigned.
+ * @return The 8 bytes to log: an int64_t, uint64_t or double by kind.
+ */
+static uint64_t readValue(const struct seminal_input_site *site, unsigned i,
+                          void *pointer) {
+  unsigned char kind = site->kind[i];
+  unsigned char size = site->size[i];
+  int wide = size == SIZE_LONG;
+  uint64_t bits = 0;
+  if (kind == SEMINAL_INPUT_FLOAT) {
+    double value = size == SIZE_LONG           ? *(double *)pointer
+                   : size == SIZE_LONG_DOUBLE ? (double)*(long double *)pointer
+                                              : *(float *)pointer;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+  if (kind == SEMINAL_INPUT_LENGTH) {
+    if (site->width[i]) {
+      return site->width[i];
+    }
+    const void *text = site->allocated[i] ? *(void **)pointer : pointer;
+    if (!text) {
+      return 0;
+    }
+    return wide ? wcslen(text) : strlen(text);
+  }
+  if (kind == SEMINAL_INPUT_CHAR) {
+    return wide ? (uint64_t)*(wchar_t *)pointer : *(unsigned char *)pointer;
+  }
+
+  int64_t value;
+  switch (size) {
+  case SIZE_CHAR:
+    value = kind == SEMINAL_INPUT_SIGNED ? *(signed char *)pointer
+                                         : *(unsigned char *)pointer;
+    break;
+  case SIZE_SHORT:
+    value = kind == SEMINAL_INPUT_SIGNED ? *(short *)pointer
+                                         : *(unsigned short *)pointer;
+    break;
+  case SIZE_LONG:
+  case SIZE_PTRDIFF:
+    value = *(long *)pointer;
+    break;
+  case SIZE_LONG_LONG:
+  case SIZE_INTMAX:
+    value = *(long long *)pointer;
+    break;
+  case SIZE_SIZE:
+    value = (int64_t)*(size_t *)pointer;
+    break;
+  default:
+    value = kind == SEMINAL_INPUT_SIGNED ? (int64_t)*(int *)pointer
+                                         : (int64_t)*(unsigned *)pointer;
+    break;
+  }
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+/** Writes the buffered input records to the log. */
+static void flushInputLog(void) {
+  if (inputLog >= 0 && inputLength &&
+      write(inputLog, inputBuffer, inputLength) != (ssize_t)inputLength) {
+    close(inputLog);
+    inputLog = -1;
+  }
+  inputLength = 0;
+}
+
+/**
+ * Appends bytes to the input log buffer, flushing it first if they do not
+ * fit.
+ */
+static void appendInput(const void *bytes, size_t length) {
+  if (inputLength + length > sizeof(inputBuffer)) {
+    flushInputLog();
+  }
+  memcpy(inputBuffer + inputLength, bytes, length);
+  inputLength += length;
+}
+
+/**
+ * Logs a wrapped call: its site record on the first call, then a call record
+ * with the values the call assigned.
+ *
+ * @param site The call site ID.
+ * @param location The call site's `function:line`.
+ * @param format The call's format string.
+ * @param result What the call returned.
+ * @param args The call's arguments after the format string.
+ */
+static void logInputCall(unsigned site, const char *location,
+                         const char *format, int result, va_list args) {
+  if (inputLog < 0) {
+    return;
+  }
+
+  // Sites past the count given at init may change format, and are parsed on
+  // every call
+  struct seminal_input_site uncached = {0};
+  struct seminal_input_site *conversions =
+      site < inputSiteCount ? &inputSites[site] : &uncached;
+  if (!conversions->parsed) {
+    parseFormat(format, conversions);
+    conversions->parsed = 1;
+
+    unsigned char kinds[SEMINAL_MAX_CONVERSIONS];
+    uint8_t counted = 0;
+    for (unsigned i = 0; i < conversions->count; ++i) {
+      if (conversions->kind[i]) {
+        kinds[counted++] = conversions->kind[i];
+      }
+    }
+    size_t length = strlen(location);
+    uint16_t locationLength = length > UINT16_MAX ? UINT16_MAX : length;
+    appendInput("S", 1);
+    appendInput(&site, sizeof(uint32_t));
+    appendInput(&locationLength, sizeof(locationLength));
+    appendInput(location, locationLength);
+    appendInput(&counted, sizeof(counted));
+    appendInput(kinds, counted);
+  }
+
+  uint64_t values[SEMINAL_MAX_CONVERSIONS];
+  uint8_t count = 0;
+  for (unsigned i = 0; i < conversions->count && (int)count < result; ++i) {
+    void *pointer = va_arg(args, void *);
+    if (conversions->kind[i]) {
+      values[count++] =
+          readValue(conversions, i, pointer);
+    }
+  }
+  int32_t returned = result;
+  appendInput("C", 1);
+  appendInput(&site, sizeof(uint32_t));
+  appendInput(&returned, sizeof(returned));
+  appendInput(&count, sizeof(count));
+  appendInput(values, count * sizeof(values[0]));
+}
+
+/**
+ * Returns the monotonic time, in nanoseconds.
+ */
+static unsigned long long wallNanoseconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/**
+ * Adds a read to the counters of its handle. Reads of a stream past the
+ * table's capacity are not counted.
+ *
+ * @param key The handle's key, see struct seminal_io_handle.
+ * @param fd The handle's file descriptor.
+ * @param bytes The number of bytes read.
+ * @param start When the read started.
+ */
+static void countRead(uintptr_t key, int fd, unsigned long long bytes,
+                      unsigned long long start) {
+  unsigned long long elapsed = wallNanoseconds() - start;
+  unsigned i = (unsigned)((key >> 4) ^ key) % SEMINAL_MAX_HANDLES;
+  for (unsigned probe = 0; probe < SEMINAL_MAX_HANDLES; ++probe) {
+    struct seminal_io_handle *handle = &ioHandles[i];
+    if (!handle->key) {
+      handle->key = key;
+      handle->fd = fd;
+    }
+    if (handle->key == key) {
+      handle->bytes += bytes;
+      handle->calls++;
+      handle->nanoseconds += elapsed;
+      return;
+    }
+    i = (i + 1) % SEMINAL_MAX_HANDLES;
+  }
+}
+
+/** Adds a read of a stream to its counters. */
+static void countStreamRead(FILE *stream, unsigned long long bytes,
+                            unsigned long long start) {
+  countRead((uintptr_t)stream, stream ? fileno(stream) : -1, bytes, start);
+}
+
+/** Writes one summary line per stream read. */
+static void writeIOSummary(void) {
+  FILE *summary = fopen(ioSummary, "w");
+  if (!summary) {
+    return;
+  }
+  for (unsigned i = 0; i < SEMINAL_MAX_HANDLES; ++i) {
+    const struct seminal_io_handle *handle = &ioHandles[i];
+    if (handle->key) {
+      fprintf(summary, "%s %d bytes %llu calls %llu io_ns %llu\n",
+              handle->key & 1 ? "fd" : "stream", handle->fd, handle->bytes,
+              handle->calls, handle->nanoseconds);
+    }
+  }
+  fclose(summary);
+}
+
+/** Records the high-water marks of the tracked buffers and publishes them. */
+static void recordBufferMarks(void) {
+  for (unsigned i = 0; i < bufferMarkCount; ++i) {
+    char site[256];
+    snprintf(site, sizeof(site), "%s@%u", bufferMarks[i].name,
+             bufferMarks[i].line);
+    __seminal_record_value(strdup(site), (double)*bufferMarks[i].mark);
+
+    // The buffer's mark is the highest of its stores'
+    long long highest = 0;
+    for (unsigned j = 0; j < bufferMarkCount; ++j) {
+      if (strcmp(bufferMarks[j].name, bufferMarks[i].name) == 0 &&
+          *bufferMarks[j].mark > highest) {
+        highest = *bufferMarks[j].mark;
+      }
+    }
+    __seminal_record_value(bufferMarks[i].name, (double)highest);
+  }
+  __seminal_snapshot_flush();
+}
+
+/** Appends the run's record to the dataset. */
+static void appendDatasetRecord(void) {
+  unsigned columns = 2 + dataset.featureCount + dataset.counterCount;
+  double *record = malloc(columns * sizeof(double));
+  if (!record) {
+    return;
+  }
+  record[0] = (double)(wallNanoseconds() - dataset.start);
+  record[1] = (double)cpuNanoseconds();
+  for (unsigned i = 0; i < dataset.featureCount; ++i) {
+    double value = NAN;
+    for (unsigned j = 0; j < featureCount; ++j) {
+      if (strcmp(features[j].name, dataset.features[i]) == 0) {
+        value = features[j].value;
+        break;
+      }
+    }
+    record[2 + i] = value;
+  }
+  for (unsigned i = 0; i < dataset.counterCount; ++i) {
+    record[2 + dataset.featureCount + i] = (double)dataset.counters[i];
+  }
+
+  int fd = open(dataset.path, O_CREAT | O_WRONLY | O_APPEND, 0644);
+  if (fd >= 0) {
+    ssize_t written = write(fd, record, columns * sizeof(double));
+    (void)written;
+    close(fd);
+  }
+  free(record);
+}
+
+// ---- END HELPER FUNCTIONS ----
+
+void __seminal_snapshot_init(const char *path, int isShared) {
+  const char *override = getenv("SEMINAL_SNAPSHOT");
+  target = override && *override ? override : path;
+  shared = isShared;
+}
+
+void __seminal_record_value(const char *name, double value) {
+  unsigned i = 0;
+  while (i < featureCount && strcmp(features[i].name, name) != 0) {
+    ++i;
+  }
+  if (i == SEMINAL_MAX_FEATURES) {
+    return;
+  }
+  if (i == featureCount) {
+    features[featureCount++].name = name;
+  }
+  features[i].value = value;
+}
+
+void __seminal_record_stream(const char *name, FILE *stream) {
+  struct stat status;
+  if (!stream || fstat(fileno(stream), &status) != 0 ||
+      !S_ISREG(status.st_mode)) {
+    __seminal_record_value(name, -1);
+    return;
+  }
+  __seminal_record_value(name, (double)status.st_size);
+}
+
+void __seminal_record_buffer(const char *name, const char *buffer,
+                             unsigned long capacity) {
+  if (!buffer) {
+    __seminal_record_value(name, 0);
+    return;
+  }
+  __seminal_record_value(name, (double)(capacity ? strnlen(buffer, capacity)
+                                                 : strlen(buffer)));
+}
+
+void __seminal_snapshot_flush(void) {
+  if (shared) {
+    if (!snapshot && !(snapshot = mapSnapshot())) {
+      return;
+    }
+    snapshot->sequence++;
+    __sync_synchronize();
+    snapshot->length = formatSnapshot(snapshot->text, sizeof(snapshot->text));
+    __sync_synchronize();
+    snapshot->sequence++;
+    return;
+  }
+
+  char text[SEMINAL_SHM_SIZE];
+  size_t length = formatSnapshot(text, sizeof(text));
+  char temporary[4096];
+  snprintf(temporary, sizeof(temporary), "%s.tmp", target);
+  int fd = open(temporary, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+  if (fd < 0) {
+    return;
+  }
+  ssize_t written = write(fd, text, length);
+  close(fd);
+  if (written == (ssize_t)length) {
+    rename(temporary, target);
+  }
+}
+
+void __seminal_snapshot_exit(void) {
+  __seminal_snapshot_flush();
+  char text[SEMINAL_SHM_SIZE];
+  size_t length = formatSnapshot(text, sizeof(text));
+  fwrite(text, 1, length, stdout);
+  exit(0);
+}
+
+void __seminal_input_log_init(const char *path, unsigned sites) {
+  const char *override = getenv("SEMINAL_INPUT_LOG");
+  inputLog = open(override && *override ? override : path,
+                  O_CREAT | O_WRONLY | O_TRUNC, 0644);
+  inputSites = calloc(sites, sizeof(*inputSites));
+  inputSiteCount = inputSites ? sites : 0;
+  atexit(flushInputLog);
+}
+
+int __seminal_scanf(unsigned site, const char *location, const char *format,
+                    ...) {
+  va_list args, pointers;
+  va_start(args, format);
+  va_copy(pointers, args);
+  int result = vscanf(format, args);
+  logInputCall(site, location, format, result, pointers);
+  va_end(pointers);
+  va_end(args);
+  return result;
+}
+
+int __seminal_fscanf(unsigned site, const char *location, FILE *stream,
+                     const char *format, ...) {
+  va_list args, pointers;
+  va_start(args, format);
+  va_copy(pointers, args);
+  int result = vfscanf(stream, format, args);
+  logInputCall(site, location, format, result, pointers);
+  va_end(pointers);
+  va_end(args);
+  return result;
+}
+
+int __seminal_sscanf(unsigned site, const char *location, const char *input,
+                     const char *format, ...) {
+  va_list args, pointers;
+  va_start(args, format);
+  va_copy(pointers, args);
+  int result = vsscanf(input, format, args);
+  logInputCall(site, location, format, result, pointers);
+  va_end(pointers);
+  va_end(args);
+  return result;
+}
+
+void __seminal_io_init(const char *path) {
+  const char *override = getenv("SEMINAL_IO_SUMMARY");
+  ioSummary = override && *override ? override : path;
+  atexit(writeIOSummary);
+}
+
+void __seminal_track_buffer(const char *name, unsigned line,
+                            const long long *mark) {
+  if (bufferMarkCount == SEMINAL_MAX_FEATURES) {
+    return;
+  }
+  if (bufferMarkCount == 0) {
+    atexit(recordBufferMarks);
+  }
+  bufferMarks[bufferMarkCount].name = name;
+  bufferMarks[bufferMarkCount].line = line;
+  bufferMarks[bufferMarkCount++].mark = mark;
+}
+
+void __seminal_dataset_init(const char *path, const char *const *features,
+                            unsigned featureCount, const long long *counters,
+                            unsigned counterCount) {
+  const char *override = getenv("SEMINAL_DATASET");
+  dataset.path = override && *override ? override : path;
+  dataset.features = features;
+  dataset.featureCount = featureCount;
+  dataset.counters = counters;
+  dataset.counterCount = counterCount;
+  dataset.start = wallNanoseconds();
+  atexit(appendDatasetRecord);
+}
+
+int __seminal_getc(FILE *stream) {
+  unsigned long long start = wallNanoseconds();
+  int c = getc(stream);
+  countStreamRead(stream, c != EOF, start);
+  return c;
+}
+
+int __seminal_fgetc(FILE *stream) {
+  unsigned long long start = wallNanoseconds();
+  int c = fgetc(stream);
+  countStreamRead(stream, c != EOF, start);
+  return c;
+}
+
+int __seminal_getc_unlocked(FILE *stream) {
+  unsigned long long start = wallNanoseconds();
+  int c = getc_unlocked(stream);
+  countStreamRead(stream, c != EOF, start);
+  return c;
+}
+
+int __seminal_getchar(void) {
+  unsigned long long start = wallNanoseconds();
+  int c = getchar();
+  countStreamRead(stdin, c != EOF, start);
+  return c;
+}
+
+char *__seminal_fgets(char *buffer, int size, FILE *stream) {
+  unsigned long long start = wallNanoseconds();
+  char *line = fgets(buffer, size, stream);
+  countStreamRead(stream, line ? strlen(line) : 0, start);
+  return line;
+}
+
+size_t __seminal_fread(void *buffer, size_t size, size_t count, FILE *stream) {
+  unsigned long long start = wallNanoseconds();
+  size_t items = fread(buffer, size, count, stream);
+  countStreamRead(stream, items * size, start);
+  return items;
+}
+
+long __seminal_getline(char **line, size_t *capacity, FILE *stream) {
+  unsigned long long start = wallNanoseconds();
+  ssize_t length = getline(line, capacity, stream);
+  countStreamRead(stream, length > 0 ? length : 0, start);
+  return length;
+}
+
+long __seminal_getdelim(char **line, size_t *capacity, int delimiter,
+                        FILE *stream) {
+  unsigned long long start = wallNanoseconds();
+  ssize_t length = getdelim(line, capacity, delimiter, stream);
+  countStreamRead(stream, length > 0 ? length : 0, start);
+  return length;
+}
+
+long __seminal_read(int fd, void *buffer, size_t count) {
+  unsigned long long start = wallNanoseconds();
+  ssize_t length = read(fd, buffer, count);
+  countRead(((uintptr_t)fd + 1) << 1 | 1, fd, length > 0 ? length : 0, start);
+  return length;
+}
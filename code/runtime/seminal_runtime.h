@@ -0,0 +1,142 @@
+/**
+ * Runtime for programs instrumented by the Seminal Instrumenter.
+ *
+ * @file seminal_runtime.h
+ * @brief The calls the `seminal-instrument` pass inserts. Features are
+ * recorded by name and published together by __seminal_snapshot_flush(),
+ * one `name value` line each, so a supervisor always sees a complete vector.
+ * With `-seminal-wrap-input`, scanf, fscanf and sscanf calls are redirected to
+ * the __seminal_*scanf() wrappers, which log the values each call parses.
+ * With `-seminal-count-input`, stream reads are redirected to wrappers with
+ * the same signature that count the bytes, calls and time of each stream.
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#ifndef SEMINAL_RUNTIME_H
+#define SEMINAL_RUNTIME_H
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Sets where snapshots are published: a file path, or a POSIX shared memory
+ * name if shared is nonzero. The SEMINAL_SNAPSHOT environment variable
+ * overrides the target.
+ */
+void __seminal_snapshot_init(const char *target, int shared);
+
+/** Records the value of a scalar feature. */
+void __seminal_record_value(const char *name, double value);
+
+/** Records the size in bytes of the file behind a stream; -1 if unknown. */
+void __seminal_record_stream(const char *name, FILE *stream);
+
+/**
+ * Records the length of the string in a buffer, reading at most capacity
+ * bytes (no limit if capacity is 0).
+ */
+void __seminal_record_buffer(const char *name, const char *buffer,
+                             unsigned long capacity);
+
+/** Publishes every feature recorded so far. */
+void __seminal_snapshot_flush(void);
+
+/**
+ * Publishes the features, prints them on standard output and ends the
+ * program; a feature extractor stops here.
+ */
+void __seminal_snapshot_exit(void);
+
+/**
+ * Opens the binary log of parsed input values; sites is the number of wrapped
+ * call sites with a constant format, numbered from 0, whose format is parsed
+ * once. Sites numbered from sites on have a format that may change, parsed
+ * on every call. The SEMINAL_INPUT_LOG environment variable overrides the
+ * path.
+ *
+ * The log is a sequence of records in host byte order. The first call at a
+ * site with a constant format, and every call at another site, writes a site
+ * record: the byte 'S', the site ID (uint32), the length
+ * (uint16) and text of its `function:line` location, then the number (uint8)
+ * and kinds (one byte each, see enum seminal_input_kind) of its conversions.
+ * Every call then writes a call record: the byte 'C', the site ID (uint32),
+ * the call's return value (int32), the number of values (uint8) and that many
+ * 8-byte values, one per conversion that was assigned.
+ */
+void __seminal_input_log_init(const char *path, unsigned sites);
+
+/**
+ * What an input value logged for a conversion holds. Wide conversions (%lc,
+ * %ls, %l[) are logged in wide characters.
+ */
+enum seminal_input_kind {
+  SEMINAL_INPUT_SIGNED = 1,   /**< An int64_t, from %d or %i. */
+  SEMINAL_INPUT_UNSIGNED = 2, /**< A uint64_t, from %u, %o, %x or %p. */
+  SEMINAL_INPUT_FLOAT = 3,    /**< A double, from %f, %e, %g or %a. */
+  SEMINAL_INPUT_CHAR = 4,     /**< The first character, from %c or %lc. */
+  SEMINAL_INPUT_LENGTH = 5    /**< A %s or %[ length, or a %mc's width. */
+};
+
+/** Calls scanf() and logs the values it parses. */
+int __seminal_scanf(unsigned site, const char *location, const char *format,
+                    ...);
+
+/** Calls fscanf() and logs the values it parses. */
+int __seminal_fscanf(unsigned site, const char *location, FILE *stream,
+                     const char *format, ...);
+
+/** Calls sscanf() and logs the values it parses. */
+int __seminal_sscanf(unsigned site, const char *location, const char *input,
+                     const char *format, ...);
+
+/**
+ * Sets where the stream read summary is written at exit: one line per stream,
+ * `stream <fd> bytes <n> calls <n> io_ns <n>`, or `fd <fd> ...` for read().
+ * The SEMINAL_IO_SUMMARY environment variable overrides the path.
+ */
+void __seminal_io_init(const char *path);
+
+/**
+ * Registers the high-water mark a store into a buffer keeps: one more than
+ * the highest index it has written. At exit, each buffer's marks are
+ * snapshot as `<name>@<line>` and their maximum as `<name>`.
+ */
+void __seminal_track_buffer(const char *name, unsigned line,
+                            const long long *mark);
+
+/**
+ * Appends one record to a dataset at exit: the run's wall and CPU time in
+ * nanoseconds, the latest value of each named feature (NaN if never
+ * recorded) and each counter, all as doubles, in the column order of the
+ * `<path>.schema` file written by the pass. Records have a fixed size and
+ * are appended with one O_APPEND write, so concurrent runs can share a
+ * dataset. The SEMINAL_DATASET environment variable overrides the path.
+ */
+void __seminal_dataset_init(const char *path, const char *const *features,
+                            unsigned featureCount, const long long *counters,
+                            unsigned counterCount);
+
+int __seminal_getc(FILE *stream);
+int __seminal_fgetc(FILE *stream);
+int __seminal_getc_unlocked(FILE *stream);
+int __seminal_getchar(void);
+char *__seminal_fgets(char *buffer, int size, FILE *stream);
+size_t __seminal_fread(void *buffer, size_t size, size_t count, FILE *stream);
+long __seminal_getline(char **line, size_t *capacity, FILE *stream);
+long __seminal_getdelim(char **line, size_t *capacity, int delimiter,
+                        FILE *stream);
+long __seminal_read(int fd, void *buffer, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEMINAL_RUNTIME_H
@@ -0,0 +1,237 @@
+/**
+ * Function Pointer Logger trace aggregator.
+ *
+ * @file fpl_aggregate.cpp
+ * @brief Summarizes a `branch-pointer_trace.txt`: how often each branch edge
+ * was taken, how hot each source line is, and where indirect calls went. The
+ * trace is mapped and split at line boundaries into one part per thread;
+ * each thread counts its part into tables of its own, and the tables are
+ * added up at the end, so no counter is shared while scanning.
+ *
+ * Usage: fpl-aggregate [-j threads] [-d branch-dictionary.txt]
+ *                      [-o report.txt] [branch-pointer_trace.txt]
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#include "fpl_trace.h"
+
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+/** The counts of one part of a trace. */
+struct TraceCounts {
+  std::vector<uint64_t> branches;
+  std::unordered_map<uint64_t, uint64_t> calls;
+
+  /** Branch events whose ID is past the dictionary, or corrupt. */
+  uint64_t unknown = 0;
+};
+
+/** How often a source line was reached through branches. */
+struct LineCounts {
+  /** Times a branch on the line was executed. */
+  uint64_t executed = 0;
+
+  /** Times a branch edge led to the line. */
+  uint64_t entered = 0;
+};
+
+} // namespace
+
+// ---- HELPER FUNCTIONS ----
+
+/**
+ * Counts the events of a trace range.
+ *
+ * @param begin The start of the range, at the start of a line.
+ * @param end The end of the range.
+ * @param limit The number of branch IDs counted one by one.
+ * @param counts The counts to add to.
+ */
+static void countRange(const char *begin, const char *end, uint64_t limit,
+                       TraceCounts *counts) {
+  fpl::scanTrace(
+      begin, end,
+      [&](uint64_t id) {
+        if (id >= limit) {
+          counts->unknown++;
+          return;
+        }
+        if (id >= counts->branches.size()) {
+          counts->branches.resize(std::min<uint64_t>(
+              limit, std::max<uint64_t>(id + 1, counts->branches.size() * 2)));
+        }
+        counts->branches[id]++;
+      },
+      [&](uint64_t address) { counts->calls[address]++; });
+}
+
+/**
+ * Counts a whole trace, one part per thread.
+ *
+ * @param trace The mapped trace.
+ * @param threads The number of threads.
+ * @param limit The number of branch IDs counted one by one.
+ * @param total The sum of the parts' counts.
+ */
+static void countTrace(const fpl::MappedFile &trace, unsigned threads,
+                       uint64_t limit, TraceCounts *total) {
+  std::vector<const char *> bounds =
+      fpl::splitLines(trace.begin(), trace.end(), threads);
+  std::vector<TraceCounts> parts(threads);
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < threads; ++i) {
+    workers.emplace_back(countRange, bounds[i], bounds[i + 1], limit,
+                         &parts[i]);
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+
+  for (const TraceCounts &part : parts) {
+    if (part.branches.size() > total->branches.size()) {
+      total->branches.resize(part.branches.size());
+    }
+    for (size_t id = 0; id < part.branches.size(); ++id) {
+      total->branches[id] += part.branches[id];
+    }
+    for (const auto &[address, count] : part.calls) {
+      total->calls[address] += count;
+    }
+    total->unknown += part.unknown;
+  }
+}
+
+/**
+ * Writes the report: each taken branch edge, the source lines by hotness,
+ * and the indirect call targets by count.
+ *
+ * @param out Where to write.
+ * @param counts The counts of the trace.
+ * @param dictionary The branch edges, indexed by ID.
+ */
+static void writeReport(FILE *out, const TraceCounts &counts,
+                        const std::vector<fpl::BranchInfo> &dictionary) {
+  std::map<std::pair<std::string, unsigned>, LineCounts> lines;
+  fprintf(out, "# branch edges: id count file source_line target_line\n");
+  for (size_t id = 0; id < counts.branches.size(); ++id) {
+    uint64_t count = counts.branches[id];
+    if (!count) {
+      continue;
+    }
+    if (id >= dictionary.size() || !dictionary[id].known) {
+      fprintf(out, "br_%zu %llu ? 0 0\n", id, (unsigned long long)count);
+      continue;
+    }
+    const fpl::BranchInfo &info = dictionary[id];
+    fprintf(out, "br_%zu %llu %s %u %u\n", id, (unsigned long long)count,
+            info.file.c_str(), info.sourceLine, info.targetLine);
+    lines[{info.file, info.sourceLine}].executed += count;
+    lines[{info.file, info.targetLine}].entered += count;
+  }
+  if (counts.unknown) {
+    fprintf(out, "# %llu events with unknown or corrupt IDs\n",
+            (unsigned long long)counts.unknown);
+  }
+
+  std::vector<std::pair<const std::pair<std::string, unsigned> *,
+                        const LineCounts *>>
+      hottest;
+  for (const auto &entry : lines) {
+    hottest.push_back({&entry.first, &entry.second});
+  }
+  std::stable_sort(hottest.begin(), hottest.end(),
+                   [](const auto &a, const auto &b) {
+                     return std::max(a.second->executed, a.second->entered) >
+                            std::max(b.second->executed, b.second->entered);
+                   });
+  fprintf(out, "\n# source lines: file:line executed entered\n");
+  for (const auto &[line, count] : hottest) {
+    fprintf(out, "%s:%u %llu %llu\n", line->first.c_str(), line->second,
+            (unsigned long long)count->executed,
+            (unsigned long long)count->entered);
+  }
+
+  std::vector<std::pair<uint64_t, uint64_t>> calls(counts.calls.begin(),
+                                                   counts.calls.end());
+  std::sort(calls.begin(), calls.end(), [](const auto &a, const auto &b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  fprintf(out, "\n# indirect call targets: address count\n");
+  for (const auto &[address, count] : calls) {
+    fprintf(out, "*func_0x%llx %llu\n", (unsigned long long)address,
+            (unsigned long long)count);
+  }
+}
+
+// ---- END HELPER FUNCTIONS ----
+
+int main(int argc, char **argv) {
+  const char *tracePath = "branch-pointer_trace.txt";
+  const char *dictionaryPath = "branch-dictionary.txt";
+  const char *reportPath = nullptr;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+  int opt;
+  while ((opt = getopt(argc, argv, "j:d:o:")) != -1) {
+    switch (opt) {
+    case 'j':
+      threads = std::max(1, atoi(optarg));
+      break;
+    case 'd':
+      dictionaryPath = optarg;
+      break;
+    case 'o':
+      reportPath = optarg;
+      break;
+    default:
+      fprintf(stderr,
+              "Usage: %s [-j threads] [-d dictionary] [-o report] [trace]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (optind < argc) {
+    tracePath = argv[optind];
+  }
+
+  fpl::MappedFile trace;
+  if (!trace.open(tracePath)) {
+    fprintf(stderr, "Error: Could not map %s.\n", tracePath);
+    return 1;
+  }
+  std::vector<fpl::BranchInfo> dictionary;
+  if (!fpl::readBranchDictionary(dictionaryPath, &dictionary)) {
+    fprintf(stderr, "Warning: Could not read %s; lines are unknown.\n",
+            dictionaryPath);
+  }
+
+  // Small traces are not worth a thread per core
+  threads = std::min<uint64_t>(threads, trace.length() / (1 << 20) + 1);
+  // IDs past the dictionary, or corrupt ones, are only counted in total
+  uint64_t limit = dictionary.empty() ? fpl::MaxBranchId + 1
+                                      : dictionary.size();
+  TraceCounts counts;
+  countTrace(trace, threads, limit, &counts);
+
+  FILE *out = reportPath ? fopen(reportPath, "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "Error: Could not write %s.\n", reportPath);
+    return 1;
+  }
+  writeReport(out, counts, dictionary);
+  if (out != stdout) {
+    fclose(out);
+  }
+  return 0;
+}
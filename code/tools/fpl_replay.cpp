@@ -0,0 +1,367 @@
+/**
+ * Function Pointer Logger path replay.
+ *
+ * @file fpl_replay.cpp
+ * @brief Reconstructs the basic blocks and source lines a traced run
+ * executed. Each event of `branch-pointer_trace.txt` is expanded with the
+ * path the logger recorded for it in `branch-paths.txt`: the code that runs
+ * from the event until the next one. A `br_<id>` edge runs its target block
+ * and the blocks it reaches through unconditional branches, a `fn_<id>` the
+ * entry of a function, and a `ret_<id>` the rest of the caller after a call
+ * returns. Every path ends at a logged branch, a return or a call that may
+ * log, so the paths of the events, in order, are the executed blocks. The
+ * trace is mapped and decoded as a stream, so it is never loaded whole.
+ *
+ * Seeking uses a chunk index, `<trace>.idx`, holding the offset of every
+ * ChunkEvents-th event. It is built on first use, counting the events of
+ * each part of the trace in parallel, and rebuilt when the trace changes.
+ * The logger writes one stream for the whole process, so its events are
+ * decoded in that one order.
+ *
+ * Usage: fpl-replay [-p branch-paths.txt] [-s first-event] [-n events] [-l]
+ *                   [branch-pointer_trace.txt]
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#include "fpl_trace.h"
+
+#include <algorithm>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+constexpr char IndexMagic[8] = {'F', 'P', 'L', 'I', 'D', 'X', '1', '\0'};
+constexpr uint64_t ChunkEvents = 1 << 16;
+
+struct IndexHeader {
+  char magic[8];
+  uint64_t chunkEvents;
+  uint64_t events;
+  uint64_t traceSize;
+  int64_t traceTime;
+};
+
+/** The path recorded for an event. */
+struct EdgePath {
+  /** The kind of event: `br`, `fn` or `ret`. */
+  std::string kind;
+
+  std::string function;
+  std::string file;
+
+  /** The blocks, `bb<index>:<line>,...` separated by spaces. */
+  std::string blocks;
+
+  /** The source lines of the blocks, in order. */
+  std::vector<unsigned> lines;
+};
+
+} // namespace
+
+// ---- HELPER FUNCTIONS ----
+
+/**
+ * Reads the paths of the events, `<kind>_<id>: <function>, <file>, <blocks>`
+ * per line.
+ *
+ * @param path The paths file.
+ * @param paths The paths, indexed by ID.
+ * @return False if the file cannot be read.
+ */
+static bool readPaths(const char *path, std::vector<EdgePath> *paths) {
+  fpl::MappedFile file;
+  if (!file.open(path)) {
+    return false;
+  }
+  const char *it = file.begin();
+  while (it < file.end()) {
+    const char *newline =
+        static_cast<const char *>(memchr(it, '\n', file.end() - it));
+    const char *end = newline ? newline : file.end();
+    std::string_view line(it, end - it);
+    it = end + 1;
+
+    size_t underscore = line.find('_');
+    size_t colon = line.find(": ");
+    if (underscore == std::string_view::npos ||
+        colon == std::string_view::npos || underscore > colon) {
+      continue;
+    }
+    const char *cursor = line.data() + underscore + 1;
+    uint64_t id = fpl::parseDecimal(cursor, line.data() + colon);
+    size_t function = colon + 2;
+    size_t fileName = line.find(", ", function);
+    size_t blocks = fileName == std::string_view::npos
+                        ? fileName
+                        : line.find(", ", fileName + 2);
+    if (id > fpl::MaxBranchId || blocks == std::string_view::npos) {
+      continue;
+    }
+    if (id >= paths->size()) {
+      paths->resize(id + 1);
+    }
+    EdgePath &edge = (*paths)[id];
+    edge.kind = line.substr(0, underscore);
+    edge.function = line.substr(function, fileName - function);
+    edge.file = line.substr(fileName + 2, blocks - fileName - 2);
+    edge.blocks = line.substr(blocks + 2);
+
+    // Lines follow each "bb<index>:" and are separated by commas
+    const char *c = edge.blocks.c_str();
+    const char *blocksEnd = c + edge.blocks.size();
+    while (c < blocksEnd) {
+      const char *label =
+          static_cast<const char *>(memchr(c, ':', blocksEnd - c));
+      if (!label) {
+        break;
+      }
+      c = label + 1;
+      while (c < blocksEnd && *c != ' ') {
+        if (*c >= '0' && *c <= '9') {
+          edge.lines.push_back(fpl::parseDecimal(c, blocksEnd));
+        } else {
+          ++c;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns the number of events (lines) in a range.
+ */
+static uint64_t countEvents(const char *begin, const char *end) {
+  uint64_t events = 0;
+  for (const char *it = begin; it < end; ++events) {
+    const char *newline =
+        static_cast<const char *>(memchr(it, '\n', end - it));
+    it = newline ? newline + 1 : end;
+  }
+  return events;
+}
+
+/**
+ * Builds the chunk index of a trace: the events of each part are counted in
+ * parallel, then each part records the offsets of the chunk starts it holds.
+ *
+ * @param trace The mapped trace.
+ * @param offsets The offset of every ChunkEvents-th event.
+ * @return The number of events in the trace.
+ */
+static uint64_t buildIndex(const fpl::MappedFile &trace,
+                           std::vector<uint64_t> *offsets) {
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min<uint64_t>(threads, trace.length() / (1 << 20) + 1);
+  std::vector<const char *> bounds =
+      fpl::splitLines(trace.begin(), trace.end(), threads);
+
+  std::vector<uint64_t> counts(threads);
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < threads; ++i) {
+    workers.emplace_back(
+        [&, i] { counts[i] = countEvents(bounds[i], bounds[i + 1]); });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+
+  std::vector<uint64_t> firsts(threads + 1, 0);
+  for (unsigned i = 0; i < threads; ++i) {
+    firsts[i + 1] = firsts[i] + counts[i];
+  }
+  uint64_t events = firsts[threads];
+  offsets->assign((events + ChunkEvents - 1) / ChunkEvents, 0);
+
+  for (unsigned i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i] {
+      uint64_t event = firsts[i];
+      for (const char *it = bounds[i]; it < bounds[i + 1]; ++event) {
+        if (event % ChunkEvents == 0) {
+          (*offsets)[event / ChunkEvents] = it - trace.begin();
+        }
+        const char *newline = static_cast<const char *>(
+            memchr(it, '\n', bounds[i + 1] - it));
+        it = newline ? newline + 1 : bounds[i + 1];
+      }
+    });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  return events;
+}
+
+/**
+ * Loads the chunk index of a trace, building and saving it if it is missing
+ * or stale.
+ *
+ * @param tracePath The trace.
+ * @param trace The mapped trace.
+ * @param offsets The offset of every ChunkEvents-th event.
+ * @return The number of events in the trace.
+ */
+static uint64_t loadIndex(const char *tracePath, const fpl::MappedFile &trace,
+                          std::vector<uint64_t> *offsets) {
+  struct stat status;
+  stat(tracePath, &status);
+  std::string indexPath = std::string(tracePath) + ".idx";
+
+  fpl::MappedFile index;
+  if (index.open(indexPath.c_str()) &&
+      index.length() >= sizeof(IndexHeader)) {
+    const IndexHeader *header =
+        reinterpret_cast<const IndexHeader *>(index.begin());
+    uint64_t chunks = (header->events + ChunkEvents - 1) / ChunkEvents;
+    if (memcmp(header->magic, IndexMagic, sizeof(IndexMagic)) == 0 &&
+        header->chunkEvents == ChunkEvents &&
+        header->traceSize == trace.length() &&
+        header->traceTime == (int64_t)status.st_mtime &&
+        index.length() == sizeof(IndexHeader) + chunks * sizeof(uint64_t)) {
+      const uint64_t *stored =
+          reinterpret_cast<const uint64_t *>(header + 1);
+      offsets->assign(stored, stored + chunks);
+      return header->events;
+    }
+  }
+
+  uint64_t events = buildIndex(trace, offsets);
+  IndexHeader header;
+  memcpy(header.magic, IndexMagic, sizeof(IndexMagic));
+  header.chunkEvents = ChunkEvents;
+  header.events = events;
+  header.traceSize = trace.length();
+  header.traceTime = status.st_mtime;
+  if (FILE *out = fopen(indexPath.c_str(), "wb")) {
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(offsets->data(), sizeof(uint64_t), offsets->size(), out);
+    fclose(out);
+  }
+  return events;
+}
+
+/**
+ * Writes the blocks or source lines of a range of events.
+ *
+ * @param it The first event.
+ * @param end The end of the trace.
+ * @param first The number of the first event.
+ * @param count The number of events to write.
+ * @param paths The paths of the events, indexed by ID.
+ * @param linesOnly True to write one `file:line` per executed line instead.
+ */
+static void replay(const char *it, const char *end, uint64_t first,
+                   uint64_t count, const std::vector<EdgePath> &paths,
+                   bool linesOnly) {
+  static const EdgePath Unknown;
+  uint64_t event = first;
+  const char *stop = it;
+  for (uint64_t i = 0; i < count && stop < end; ++i) {
+    const char *newline =
+        static_cast<const char *>(memchr(stop, '\n', end - stop));
+    stop = newline ? newline + 1 : end;
+  }
+
+  auto onPath = [&](uint64_t id) {
+    const EdgePath &path = id < paths.size() ? paths[id] : Unknown;
+    if (linesOnly) {
+      const char *file = path.file.empty() ? "?" : path.file.c_str();
+      for (unsigned line : path.lines) {
+        printf("%s:%u\n", file, line);
+      }
+    } else {
+      printf("%llu %s_%llu %s %s\n", (unsigned long long)event++,
+             path.kind.empty() ? "?" : path.kind.c_str(),
+             (unsigned long long)id,
+             path.function.empty() ? "?" : path.function.c_str(),
+             path.blocks.c_str());
+    }
+  };
+  fpl::scanTrace(
+      it, stop, onPath,
+      [&](uint64_t address) {
+        if (linesOnly) {
+          printf("*func_0x%llx\n", (unsigned long long)address);
+        } else {
+          printf("%llu *func_0x%llx\n", (unsigned long long)event++,
+                 (unsigned long long)address);
+        }
+      },
+      onPath);
+}
+
+// ---- END HELPER FUNCTIONS ----
+
+int main(int argc, char **argv) {
+  const char *tracePath = "branch-pointer_trace.txt";
+  const char *pathsPath = "branch-paths.txt";
+  uint64_t first = 0;
+  uint64_t count = UINT64_MAX;
+  bool linesOnly = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "p:s:n:l")) != -1) {
+    switch (opt) {
+    case 'p':
+      pathsPath = optarg;
+      break;
+    case 's':
+      first = strtoull(optarg, nullptr, 10);
+      break;
+    case 'n':
+      count = strtoull(optarg, nullptr, 10);
+      break;
+    case 'l':
+      linesOnly = true;
+      break;
+    default:
+      fprintf(stderr,
+              "Usage: %s [-p paths] [-s first-event] [-n events] [-l] "
+              "[trace]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (optind < argc) {
+    tracePath = argv[optind];
+  }
+
+  fpl::MappedFile trace;
+  if (!trace.open(tracePath)) {
+    fprintf(stderr, "Error: Could not map %s.\n", tracePath);
+    return 1;
+  }
+  std::vector<EdgePath> paths;
+  if (!readPaths(pathsPath, &paths)) {
+    fprintf(stderr, "Warning: Could not read %s; blocks are unknown.\n",
+            pathsPath);
+  }
+
+  // Seek through the chunk index, then skip to the event within its chunk
+  const char *start = trace.begin();
+  if (first) {
+    std::vector<uint64_t> offsets;
+    uint64_t events = loadIndex(tracePath, trace, &offsets);
+    if (first >= events) {
+      return 0;
+    }
+    start += offsets[first / ChunkEvents];
+    for (uint64_t skip = first % ChunkEvents; skip; --skip) {
+      start = static_cast<const char *>(
+                  memchr(start, '\n', trace.end() - start)) +
+              1;
+    }
+  }
+
+  static char buffer[1 << 20];
+  setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+  replay(start, trace.end(), first, count, paths, linesOnly);
+  return 0;
+}
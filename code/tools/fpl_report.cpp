@@ -0,0 +1,462 @@
+/**
+ * Annotated source heat reports.
+ *
+ * @file fpl_report.cpp
+ * @brief Joins the branch edge counts of an `fpl-aggregate` report (which
+ * carry the dictionary's file, source line and target line) with the source
+ * files, and writes a gcov-style listing of each file, as text and HTML. A
+ * line's count is the number of times a branch on it executed or a branch
+ * edge entered it, and each branch line is followed by its directions; the
+ * edges of the branch dictionary that never ran are listed with a count of
+ * 0. The lines the Seminal Input Detector ties to input in a file (its
+ * input-bounded loops and their bodies, input-sized allocations, the
+ * decisions input reaches and the lines those decide) are marked. Each
+ * source file is read once, line by line, while both listings are written.
+ *
+ * Usage: fpl-report [-c branch-hotness.txt] [-d branch-dictionary.txt]
+ *                   [-j seminal-values.json] [-S source-dir] [-o output-dir]
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#include "fpl_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string_view>
+
+#include "nlohmann/json.hpp"
+
+using Json = nlohmann::json;
+
+namespace {
+
+/** A branch direction: an edge from a line. */
+struct Direction {
+  uint64_t id;
+  unsigned targetLine;
+  uint64_t count;
+};
+
+/** What is known about one source line. */
+struct LineData {
+  /** Times a branch on the line executed. */
+  uint64_t executed = 0;
+
+  /** Times a branch edge entered the line. */
+  uint64_t entered = 0;
+
+  /** The edges leaving the line. */
+  std::vector<Direction> directions;
+
+  uint64_t count() const { return std::max(executed, entered); }
+};
+
+using FileData = std::map<unsigned, LineData>;
+
+/** A branch edge and the times it was taken. */
+struct Edge {
+  fpl::BranchInfo branch;
+  uint64_t count = 0;
+};
+
+} // namespace
+
+// ---- HELPER FUNCTIONS ----
+
+/**
+ * Reads the branch edge section of an `fpl-aggregate` report,
+ * `br_<id> <count> <file> <source line> <target line>` per line. The file is
+ * whatever lies between the count and the two lines, so it may hold spaces.
+ *
+ * @param path The report.
+ * @param edges The edges counted, by ID.
+ * @return False if the report cannot be read.
+ */
+static bool readCounts(const char *path, std::map<uint64_t, Edge> *edges) {
+  FILE *report = fopen(path, "r");
+  if (!report) {
+    return false;
+  }
+  char buffer[8192];
+  while (fgets(buffer, sizeof(buffer), report)) {
+    std::string_view line(buffer);
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+      line.remove_suffix(1);
+    }
+
+    // The two lines are the last fields, the ID and count the first
+    size_t targetSpace = line.rfind(' ');
+    size_t sourceSpace = targetSpace == std::string_view::npos || !targetSpace
+                             ? std::string_view::npos
+                             : line.rfind(' ', targetSpace - 1);
+    unsigned long long id, count;
+    int prefix = 0;
+    unsigned source, target;
+    if (line.substr(0, 3) != "br_" || sourceSpace == std::string_view::npos ||
+        sscanf(buffer, "br_%llu %llu %n", &id, &count, &prefix) != 2 ||
+        (size_t)prefix >= sourceSpace ||
+        sscanf(buffer + sourceSpace, " %u %u", &source, &target) != 2) {
+      continue;
+    }
+    std::string file(line.substr(prefix, sourceSpace - prefix));
+    if (file == "?") {
+      continue;
+    }
+    Edge &edge = (*edges)[id];
+    edge.branch = {file, source, target, true};
+    edge.count += count;
+  }
+  fclose(report);
+  return true;
+}
+
+/**
+ * Adds the edges of the branch dictionary that the counts do not list; they
+ * never ran.
+ *
+ * @param path The dictionary.
+ * @param edges The edges counted, by ID.
+ * @return False if the dictionary cannot be read.
+ */
+static bool addNeverTaken(const char *path, std::map<uint64_t, Edge> *edges) {
+  std::vector<fpl::BranchInfo> branches;
+  if (!fpl::readBranchDictionary(path, &branches)) {
+    return false;
+  }
+  for (size_t id = 0; id < branches.size(); ++id) {
+    if (branches[id].known) {
+      edges->emplace(id, Edge{branches[id], 0});
+    }
+  }
+  return true;
+}
+
+/**
+ * Reads the lines the detector ties to input, per file: the input-bounded
+ * loops and their bodies, the input-sized allocations, the decisions input
+ * reaches and the lines they control. A function the detector could not
+ * name a file for is skipped.
+ *
+ * @param path The detector output.
+ * @param lines The lines found, by file.
+ * @return False if the output cannot be read.
+ */
+static bool readSeminalLines(const char *path,
+                             std::map<std::string, std::set<unsigned>> *lines) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  Json output = Json::parse(file, nullptr, false);
+  if (!output.is_array()) {
+    return false;
+  }
+  for (const Json &functionJson : output) {
+    // The whole-program entry names no function and holds no lines
+    if (!functionJson.contains("function")) {
+      continue;
+    }
+    if (!functionJson.contains("file")) {
+      fprintf(stderr, "Warning: %s gives no file for %s; not marked.\n", path,
+              functionJson["function"].get<std::string>().c_str());
+      continue;
+    }
+    std::set<unsigned> &fileLines =
+        (*lines)[functionJson["file"].get<std::string>()];
+    auto add = [&](const Json &line) {
+      if (line.is_number_unsigned() && line.get<unsigned>()) {
+        fileLines.insert(line.get<unsigned>());
+      }
+    };
+    for (const char *key : {"loops", "allocations", "decisions"}) {
+      if (!functionJson.contains(key)) {
+        continue;
+      }
+      for (const Json &entry : functionJson[key]) {
+        if (entry.contains("line")) {
+          add(entry["line"]);
+        }
+        if (entry.contains("body_lines")) {
+          for (const Json &line : entry["body_lines"]) {
+            add(line);
+          }
+        }
+      }
+    }
+    if (functionJson.contains("controlled_lines")) {
+      for (const Json &line : functionJson["controlled_lines"]) {
+        add(line);
+      }
+    }
+  }
+  return true;
+}
+
+/** Writes text with the HTML special characters escaped. */
+static void writeEscaped(FILE *out, const char *text) {
+  for (const char *c = text; *c; ++c) {
+    switch (*c) {
+    case '<':
+      fputs("&lt;", out);
+      break;
+    case '>':
+      fputs("&gt;", out);
+      break;
+    case '&':
+      fputs("&amp;", out);
+      break;
+    case '"':
+      fputs("&quot;", out);
+      break;
+    default:
+      fputc(*c, out);
+    }
+  }
+}
+
+/**
+ * Returns the output name of a source file: its path with '%' and '#'
+ * percent-encoded, then separators replaced by '#' and a leading '.' encoded,
+ * so that distinct paths (`x.c`, `./x.c`, `../x.c`, `a/x.c`) get distinct
+ * names that are neither hidden nor outside the output directory.
+ */
+static std::string getReportName(const std::string &file) {
+  std::string name;
+  for (char c : file) {
+    if (c == '%') {
+      name += "%25";
+    } else if (c == '#') {
+      name += "%23";
+    } else if (c == '/' || c == '\\') {
+      name += '#';
+    } else if (c == '.' && name.empty()) {
+      name += "%2E";
+    } else {
+      name += c;
+    }
+  }
+  return name;
+}
+
+/**
+ * Writes the text and HTML listings of one source file in a single pass over
+ * its lines.
+ *
+ * @param file The file, as named by the dictionary.
+ * @param sourceDir The directory relative names are resolved against.
+ * @param outputDir The directory the listings go to.
+ * @param data The counts of the file's lines.
+ * @param seminal The lines of the file tied to input.
+ * @return False if the file or a listing cannot be opened.
+ */
+static bool writeListing(const std::string &file, const std::string &sourceDir,
+                         const std::string &outputDir, const FileData &data,
+                         const std::set<unsigned> &seminal) {
+  std::string path =
+      file[0] == '/' || sourceDir.empty() ? file : sourceDir + "/" + file;
+  FILE *source = fopen(path.c_str(), "r");
+  if (!source) {
+    fprintf(stderr, "Warning: Could not read %s.\n", path.c_str());
+    return false;
+  }
+  std::string base = outputDir + "/" + getReportName(file);
+  FILE *text = fopen((base + ".txt").c_str(), "w");
+  FILE *html = fopen((base + ".html").c_str(), "w");
+  if (!text || !html) {
+    fprintf(stderr, "Error: Could not write %s.{txt,html}.\n", base.c_str());
+    fclose(source);
+    if (text) {
+      fclose(text);
+    }
+    if (html) {
+      fclose(html);
+    }
+    return false;
+  }
+
+  uint64_t hottest = 1;
+  for (const auto &[line, counts] : data) {
+    hottest = std::max(hottest, counts.count());
+  }
+
+  fprintf(text, "%9s:%5u:Source:%s\n", "-", 0, file.c_str());
+  fprintf(html,
+          "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\">"
+          "<title>");
+  writeEscaped(html, file.c_str());
+  fprintf(html,
+          "</title><style>\n"
+          "body { font-family: monospace; }\n"
+          "table { border-collapse: collapse; }\n"
+          "td { padding: 0 8px; white-space: pre; }\n"
+          "td.count { text-align: right; }\n"
+          "tr.seminal td.line { background: #fc6; font-weight: bold; }\n"
+          "tr.branch td { color: #666; }\n"
+          "</style></head><body>\n<h2>");
+  writeEscaped(html, file.c_str());
+  fprintf(html,
+          "</h2>\n<p>Highlighted line numbers are tied to seminal inputs."
+          "</p>\n<table>\n");
+
+  auto next = data.begin();
+  char buffer[8192];
+  unsigned number = 0;
+  std::string line;
+  while (fgets(buffer, sizeof(buffer), source)) {
+    line += buffer;
+    if (line.back() != '\n' && !feof(source)) {
+      continue;
+    }
+    if (!line.empty() && line.back() == '\n') {
+      line.pop_back();
+    }
+    ++number;
+    while (next != data.end() && next->first < number) {
+      ++next;
+    }
+    const LineData *counts =
+        next != data.end() && next->first == number ? &next->second : nullptr;
+    bool isSeminal = seminal.count(number);
+
+    // Text: gcov's "count:line:source", with '*' after seminal counts
+    char count[32] = "-";
+    if (counts) {
+      snprintf(count, sizeof(count), "%llu",
+               (unsigned long long)counts->count());
+      if (!counts->count()) {
+        strcpy(count, "#####");
+      }
+    }
+    fprintf(text, "%8s%c:%5u:%s\n", count, isSeminal ? '*' : ' ', number,
+            line.c_str());
+
+    // HTML: the row's color grows with the log of its count
+    double heat = counts && counts->count()
+                      ? std::log1p((double)counts->count()) /
+                            std::log1p((double)hottest)
+                      : 0;
+    fprintf(html, "<tr%s", isSeminal ? " class=\"seminal\"" : "");
+    if (heat > 0) {
+      fprintf(html, " style=\"background: rgba(255, 64, 0, %.2f)\"",
+              heat * 0.6);
+    }
+    fprintf(html, ">");
+    fprintf(html, "<td class=\"count\">%s</td><td class=\"line\">%u</td><td>",
+            counts ? count : "", number);
+    writeEscaped(html, line.c_str());
+    fprintf(html, "</td></tr>\n");
+
+    if (counts) {
+      uint64_t total = 0;
+      for (const Direction &direction : counts->directions) {
+        total += direction.count;
+      }
+      for (const Direction &direction : counts->directions) {
+        int percent = total ? (int)(100 * direction.count / total) : 0;
+        fprintf(text, "branch br_%llu taken %llu (%d%%) -> line %u\n",
+                (unsigned long long)direction.id,
+                (unsigned long long)direction.count, percent,
+                direction.targetLine);
+        fprintf(html,
+                "<tr class=\"branch\"><td class=\"count\">%llu</td><td></td>"
+                "<td>br_%llu taken %d%% &rarr; line %u</td></tr>\n",
+                (unsigned long long)direction.count,
+                (unsigned long long)direction.id, percent,
+                direction.targetLine);
+      }
+    }
+    line.clear();
+  }
+  fprintf(html, "</table>\n</body></html>\n");
+
+  fclose(source);
+  fclose(text);
+  fclose(html);
+  printf("%s: %s.txt, %s.html\n", file.c_str(), base.c_str(), base.c_str());
+  return true;
+}
+
+// ---- END HELPER FUNCTIONS ----
+
+int main(int argc, char **argv) {
+  const char *countsPath = "branch-hotness.txt";
+  const char *seminalPath = "seminal-values.json";
+  std::string sourceDir;
+  std::string outputDir = ".";
+
+  const char *dictionaryPath = "branch-dictionary.txt";
+  int opt;
+  while ((opt = getopt(argc, argv, "c:d:j:S:o:")) != -1) {
+    switch (opt) {
+    case 'c':
+      countsPath = optarg;
+      break;
+    case 'd':
+      dictionaryPath = optarg;
+      break;
+    case 'j':
+      seminalPath = optarg;
+      break;
+    case 'S':
+      sourceDir = optarg;
+      break;
+    case 'o':
+      outputDir = optarg;
+      break;
+    default:
+      fprintf(stderr,
+              "Usage: %s [-c counts] [-d dictionary] [-j seminal-values.json] "
+              "[-S source-dir] [-o output-dir]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+
+  std::map<uint64_t, Edge> edges;
+  if (!readCounts(countsPath, &edges)) {
+    fprintf(stderr, "Error: Could not read %s.\n", countsPath);
+    return 1;
+  }
+  if (!addNeverTaken(dictionaryPath, &edges)) {
+    fprintf(stderr,
+            "Warning: Could not read %s; edges never taken are not listed.\n",
+            dictionaryPath);
+  }
+  std::map<std::string, std::set<unsigned>> seminal;
+  if (!readSeminalLines(seminalPath, &seminal)) {
+    fprintf(stderr, "Warning: Could not read %s; no lines are marked.\n",
+            seminalPath);
+  }
+
+  // A line entered only by edges never taken is not known to be dead, as it
+  // may be reached without a branch
+  std::map<std::string, FileData> files;
+  for (const auto &[id, edge] : edges) {
+    FileData &data = files[edge.branch.file];
+    LineData &source = data[edge.branch.sourceLine];
+    source.executed += edge.count;
+    source.directions.push_back({id, edge.branch.targetLine, edge.count});
+    if (edge.count) {
+      data[edge.branch.targetLine].entered += edge.count;
+    }
+  }
+
+  int status = 0;
+  const std::set<unsigned> none;
+  for (const auto &[file, data] : files) {
+    auto lines = seminal.find(file);
+    if (!writeListing(file, sourceDir, outputDir, data,
+                      lines != seminal.end() ? lines->second : none)) {
+      status = 1;
+    }
+  }
+  return status;
+}
@@ -0,0 +1,252 @@
+/**
+ * Readers for the output of the Function Pointer Logger.
+ *
+ * @file fpl_trace.h
+ * @brief The logger writes `branch-pointer_trace.txt`, one event per line:
+ * `br_<id>` when a branch edge is taken, `*func_<address>` before an
+ * indirect call, `fn_<id>` when a function is entered and `ret_<id>` when a
+ * call that may log events returns. Its `branch-dictionary.txt` maps each
+ * edge ID to
+ * `<file>, <source line>, <target line>`. Traces are mapped, not read, and
+ * scanned with memchr() so multi-gigabyte traces can be split across threads
+ * at line boundaries.
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#ifndef FPL_TRACE_H
+#define FPL_TRACE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fpl {
+
+/**
+ * The largest branch edge ID accepted. The logger numbers edges from 0, so a
+ * larger ID comes from a corrupt line; tables indexed by ID never grow past
+ * it.
+ */
+constexpr uint64_t MaxBranchId = 1 << 24;
+
+/** A branch edge of the dictionary. */
+struct BranchInfo {
+  std::string file;
+  unsigned sourceLine = 0;
+  unsigned targetLine = 0;
+  bool known = false;
+};
+
+/** A read-only memory mapping of a whole file. */
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() {
+    if (data && size) {
+      munmap(const_cast<char *>(data), size);
+    }
+  }
+
+  /**
+   * Maps a file.
+   *
+   * @param path The file to map.
+   * @return False if it cannot be opened or mapped.
+   */
+  bool open(const char *path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+      close(fd);
+      return false;
+    }
+    size = status.st_size;
+    if (size == 0) {
+      close(fd);
+      data = "";
+      return true;
+    }
+    void *memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+      size = 0;
+      return false;
+    }
+    madvise(memory, size, MADV_SEQUENTIAL);
+    data = static_cast<const char *>(memory);
+    return true;
+  }
+
+  const char *begin() const { return data; }
+  const char *end() const { return data + size; }
+  size_t length() const { return size; }
+
+private:
+  const char *data = nullptr;
+  size_t size = 0;
+};
+
+/**
+ * Parses the decimal number at the start of a range.
+ *
+ * @param it The start; left after the number.
+ * @param end The end of the range.
+ * @return The number, 0 if there is none.
+ */
+inline uint64_t parseDecimal(const char *&it, const char *end) {
+  uint64_t value = 0;
+  while (it < end && *it >= '0' && *it <= '9') {
+    value = value * 10 + (*it++ - '0');
+  }
+  return value;
+}
+
+/**
+ * Parses the hexadecimal number, with or without `0x`, at the start of a
+ * range.
+ *
+ * @param it The start; left after the number.
+ * @param end The end of the range.
+ * @return The number, 0 if there is none.
+ */
+inline uint64_t parseHex(const char *&it, const char *end) {
+  if (end - it >= 2 && it[0] == '0' && (it[1] == 'x' || it[1] == 'X')) {
+    it += 2;
+  }
+  uint64_t value = 0;
+  for (; it < end; ++it) {
+    char c = *it;
+    unsigned digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      break;
+    }
+    value = value << 4 | digit;
+  }
+  return value;
+}
+
+/**
+ * Calls onBranch(id), onCall(address) or onMarker(id) for each event of a
+ * trace range, in order; markers are the `fn_<id>` and `ret_<id>` events.
+ * Other lines are skipped.
+ *
+ * @param it The start of the range, at the start of a line.
+ * @param end The end of the range.
+ */
+template <typename BranchFn, typename CallFn, typename MarkerFn>
+void scanTrace(const char *it, const char *end, BranchFn &&onBranch,
+               CallFn &&onCall, MarkerFn &&onMarker) {
+  while (it < end) {
+    const char *newline =
+        static_cast<const char *>(memchr(it, '\n', end - it));
+    const char *lineEnd = newline ? newline : end;
+    if (lineEnd - it > 3 && it[0] == 'b' && it[1] == 'r' && it[2] == '_') {
+      const char *number = it + 3;
+      onBranch(parseDecimal(number, lineEnd));
+    } else if (lineEnd - it > 6 && memcmp(it, "*func_", 6) == 0) {
+      const char *number = it + 6;
+      onCall(parseHex(number, lineEnd));
+    } else if (lineEnd - it > 3 && memcmp(it, "fn_", 3) == 0) {
+      const char *number = it + 3;
+      onMarker(parseDecimal(number, lineEnd));
+    } else if (lineEnd - it > 4 && memcmp(it, "ret_", 4) == 0) {
+      const char *number = it + 4;
+      onMarker(parseDecimal(number, lineEnd));
+    }
+    it = lineEnd + 1;
+  }
+}
+
+/**
+ * Calls onBranch(id) or onCall(address) for each event of a trace range, in
+ * order. Markers and other lines are skipped.
+ */
+template <typename BranchFn, typename CallFn>
+void scanTrace(const char *it, const char *end, BranchFn &&onBranch,
+               CallFn &&onCall) {
+  scanTrace(it, end, onBranch, onCall, [](uint64_t) {});
+}
+
+/**
+ * Splits a range into parts that start at the start of a line.
+ *
+ * @param begin The start of the range.
+ * @param end The end of the range.
+ * @param parts The number of parts wanted.
+ * @return The parts + 1 boundaries; parts may be empty.
+ */
+inline std::vector<const char *> splitLines(const char *begin, const char *end,
+                                            unsigned parts) {
+  std::vector<const char *> bounds = {begin};
+  size_t size = end - begin;
+  for (unsigned i = 1; i < parts; ++i) {
+    const char *bound = begin + size / parts * i;
+    if (bound < bounds.back()) {
+      bound = bounds.back();
+    }
+    const char *newline =
+        static_cast<const char *>(memchr(bound, '\n', end - bound));
+    bounds.push_back(newline ? newline + 1 : end);
+  }
+  bounds.push_back(end);
+  return bounds;
+}
+
+/**
+ * Reads a branch dictionary, `br_<id>: <file>, <source>, <target>` per line.
+ *
+ * @param path The dictionary.
+ * @param branches The edges, indexed by ID.
+ * @return False if the dictionary cannot be read.
+ */
+inline bool readBranchDictionary(const char *path,
+                                 std::vector<BranchInfo> *branches) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    return false;
+  }
+  char line[4096];
+  while (fgets(line, sizeof(line), file)) {
+    unsigned id, source, target;
+    char name[4096];
+    if (sscanf(line, "br_%u: %4095[^,], %u, %u", &id, name, &source,
+               &target) != 4 ||
+        id > MaxBranchId) {
+      continue;
+    }
+    if (id >= branches->size()) {
+      branches->resize(id + 1);
+    }
+    (*branches)[id] = {name, source, target, true};
+  }
+  fclose(file);
+  return true;
+}
+
+} // namespace fpl
+
+#endif // FPL_TRACE_H
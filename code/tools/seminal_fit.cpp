@@ -0,0 +1,279 @@
+/**
+ * Empirical complexity fitting.
+ *
+ * @file seminal_fit.cpp
+ * @brief Fits the loop counters and run times of a `-seminal-dataset` file
+ * against one input feature. For each column, every candidate class f (1,
+ * log n, n, n log n, n^2, n^3, 2^n) is fitted as `a + b * f(n)` by least
+ * squares, and the class with the best R^2 is reported, the simpler one on a
+ * tie. Loops are listed next to the static estimate of the Seminal Input
+ * Detector for the same function and line.
+ *
+ * Usage: seminal-fit [-j seminal-values.json] <dataset> <feature>
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#include "fpl_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+
+#include "nlohmann/json.hpp"
+
+using Json = nlohmann::json;
+
+namespace {
+
+/** A candidate complexity class. */
+struct ComplexityClass {
+  const char *name;
+  double (*apply)(double n);
+};
+
+const ComplexityClass Classes[] = {
+    {"1", [](double) { return 0.0; }},
+    {"log(n)", [](double n) { return std::log2(std::max(n, 1.0)); }},
+    {"n", [](double n) { return n; }},
+    {"n*log(n)", [](double n) { return n * std::log2(std::max(n, 1.0)); }},
+    {"n^2", [](double n) { return n * n; }},
+    {"n^3", [](double n) { return n * n * n; }},
+    {"2^n", [](double n) { return std::exp2(std::min(n, 1000.0)); }},
+};
+
+/** The least-squares fit of a column to one class. */
+struct Fit {
+  const ComplexityClass *complexity = nullptr;
+  double intercept = NAN;
+  double slope = NAN;
+  double r2 = NAN;
+};
+
+} // namespace
+
+// ---- HELPER FUNCTIONS ----
+
+/**
+ * Fits `y = intercept + slope * f(x)` by least squares.
+ *
+ * @param x The feature values.
+ * @param y The column values.
+ * @param complexity The class f.
+ * @return The fit; its R^2 is NaN if f(x) does not vary.
+ */
+static Fit fitClass(const std::vector<double> &x, const std::vector<double> &y,
+                    const ComplexityClass &complexity) {
+  double n = x.size(), sf = 0, sy = 0, sff = 0, sfy = 0, syy = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    double f = complexity.apply(x[i]);
+    sf += f;
+    sy += y[i];
+    sff += f * f;
+    sfy += f * y[i];
+    syy += y[i] * y[i];
+  }
+
+  Fit fit;
+  fit.complexity = &complexity;
+  double varF = n * sff - sf * sf, varY = n * syy - sy * sy;
+  if (varF <= 0 || !std::isfinite(varF)) {
+    fit.intercept = sy / n;
+    fit.slope = 0;
+    return fit;
+  }
+  fit.slope = (n * sfy - sf * sy) / varF;
+  fit.intercept = (sy - fit.slope * sf) / n;
+  double cov = n * sfy - sf * sy;
+  fit.r2 = varY > 0 ? cov * cov / (varF * varY) : 1;
+  return fit;
+}
+
+/**
+ * Returns the best fit of a column: constant if the column does not vary,
+ * otherwise the class with the highest R^2, the simpler one within 1e-6.
+ */
+static Fit fitBest(const std::vector<double> &x, const std::vector<double> &y) {
+  double first = y[0];
+  bool varies = false;
+  for (double value : y) {
+    varies = varies || std::fabs(value - first) > 1e-9 * std::fabs(first);
+  }
+  if (!varies) {
+    return fitClass(x, y, Classes[0]);
+  }
+
+  Fit best;
+  for (const ComplexityClass &complexity : Classes) {
+    Fit fit = fitClass(x, y, complexity);
+    if (!std::isnan(fit.r2) &&
+        (std::isnan(best.r2) || fit.r2 > best.r2 + 1e-6)) {
+      best = fit;
+    }
+  }
+  return best.complexity ? best : fitClass(x, y, Classes[0]);
+}
+
+/**
+ * Reads the detector's static estimates of each loop, keyed by
+ * `loop@<function>:<line>` like the dataset columns.
+ *
+ * @param path The detector output.
+ * @param estimates `<trip count or bound> in <function complexity>` per loop.
+ * @return False if the output cannot be read.
+ */
+static bool readEstimates(const char *path,
+                          std::map<std::string, std::string> *estimates) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  Json output = Json::parse(file, nullptr, false);
+  if (!output.is_array()) {
+    return false;
+  }
+  for (const Json &functionJson : output) {
+    if (!functionJson.contains("function") || !functionJson.contains("loops")) {
+      continue;
+    }
+    std::string function = functionJson["function"].get<std::string>();
+    std::string complexity = functionJson.value("complexity", "?");
+    for (const Json &loop : functionJson["loops"]) {
+      std::string column =
+          "loop@" + function + ":" + std::to_string(loop.value("line", 0u));
+      std::string trips = loop.value("trip_count", loop.value("bound", "?"));
+      (*estimates)[column] = trips + " in " + complexity;
+    }
+  }
+  return true;
+}
+
+/**
+ * Reads a dataset and its schema.
+ *
+ * @param path The dataset.
+ * @param names The column names.
+ * @param records The values, one record of names->size() after another.
+ * @return False if either cannot be read.
+ */
+static bool readDataset(const char *path, std::vector<std::string> *names,
+                        std::vector<double> *records) {
+  FILE *schema = fopen((std::string(path) + ".schema").c_str(), "r");
+  if (!schema) {
+    return false;
+  }
+  char line[4096];
+  while (fgets(line, sizeof(line), schema)) {
+    line[strcspn(line, "\n")] = '\0';
+    names->push_back(line);
+  }
+  fclose(schema);
+
+  fpl::MappedFile dataset;
+  if (names->empty() || !dataset.open(path)) {
+    return false;
+  }
+  size_t count = dataset.length() / (names->size() * sizeof(double));
+  const double *values = reinterpret_cast<const double *>(dataset.begin());
+  records->assign(values, values + count * names->size());
+  return true;
+}
+
+// ---- END HELPER FUNCTIONS ----
+
+int main(int argc, char **argv) {
+  const char *seminalPath = "seminal-values.json";
+  int opt;
+  while ((opt = getopt(argc, argv, "j:")) != -1) {
+    if (opt != 'j') {
+      fprintf(stderr,
+              "Usage: %s [-j seminal-values.json] <dataset> <feature>\n",
+              argv[0]);
+      return 1;
+    }
+    seminalPath = optarg;
+  }
+  if (argc - optind != 2) {
+    fprintf(stderr,
+            "Usage: %s [-j seminal-values.json] <dataset> <feature>\n",
+            argv[0]);
+    return 1;
+  }
+  const char *datasetPath = argv[optind];
+  std::string feature = argv[optind + 1];
+
+  std::vector<std::string> names;
+  std::vector<double> records;
+  if (!readDataset(datasetPath, &names, &records)) {
+    fprintf(stderr, "Error: Could not read %s and its schema.\n", datasetPath);
+    return 1;
+  }
+  size_t featureColumn =
+      std::find(names.begin(), names.end(), feature) - names.begin();
+  if (featureColumn == names.size()) {
+    fprintf(stderr, "Error: %s has no column %s.\n", datasetPath,
+            feature.c_str());
+    return 1;
+  }
+  std::map<std::string, std::string> estimates;
+  if (!readEstimates(seminalPath, &estimates)) {
+    fprintf(stderr, "Error: Could not read the static estimates in %s.\n",
+            seminalPath);
+    return 1;
+  }
+
+  // Estimates that match no counted loop mean the two runs do not match
+  bool matched = false;
+  for (const std::string &name : names) {
+    matched = matched || estimates.count(name);
+  }
+  if (estimates.empty()) {
+    fprintf(stderr, "Warning: %s has no input-bounded loops to compare.\n",
+            seminalPath);
+  } else if (!matched) {
+    fprintf(stderr,
+            "Error: No loop of %s has a static estimate in %s; was the "
+            "detector run on the same program?\n",
+            datasetPath, seminalPath);
+    return 1;
+  }
+
+  size_t rows = records.size() / names.size();
+  printf("# %zu runs, fitted against %s\n", rows, feature.c_str());
+  printf("# column class intercept slope r2 static\n");
+  for (size_t column = 0; column < names.size(); ++column) {
+    const std::string &name = names[column];
+    bool isTime = name == "wall_ns" || name == "cpu_ns";
+    if (column == featureColumn || (!isTime && name.rfind("loop@", 0) != 0)) {
+      continue;
+    }
+
+    // Runs that did not record the feature are left out
+    std::vector<double> x, y;
+    for (size_t row = 0; row < rows; ++row) {
+      double n = records[row * names.size() + featureColumn];
+      double value = records[row * names.size() + column];
+      if (!std::isnan(n) && !std::isnan(value)) {
+        x.push_back(n);
+        y.push_back(value);
+      }
+    }
+    if (x.size() < 3) {
+      printf("%s ? nan nan nan -\n", name.c_str());
+      continue;
+    }
+
+    Fit fit = fitBest(x, y);
+    auto estimate = estimates.find(name);
+    printf("%s %s %.6g %.6g %.4f %s\n", name.c_str(),
+           fit.complexity->name, fit.intercept, fit.slope,
+           std::isnan(fit.r2) ? 1.0 : fit.r2,
+           estimate != estimates.end() ? estimate->second.c_str() : "-");
+  }
+  return 0;
+}
@@ -0,0 +1,611 @@
+/**
+ * Columnar store of per-run profiles.
+ *
+ * @file seminal_store.cpp
+ * @brief Turns the datasets appended by `-seminal-dataset` runs (one record
+ * of doubles per run, columns named by `<dataset>.schema`) into a columnar
+ * file, and answers filter, group-by and correlation queries over it. Each
+ * column is stored contiguously with its min/max and the min/max of every
+ * block of rows, so a query maps the file, touches only the columns it
+ * names, and skips blocks its filters rule out.
+ *
+ * Usage:
+ *   seminal-store build -o <store> <dataset>...
+ *   seminal-store columns <store>
+ *   seminal-store query <store> [-w <col><op><value>]... [-g <col>]
+ *                       [-s <col>[,<col>...]]
+ *   seminal-store corr <store> <col> <col> [-w <col><op><value>]...
+ *
+ * File layout (host byte order): a StoreHeader, one ColumnEntry per column,
+ * the column names, then per column its block statistics (min, max pairs)
+ * and its values, each 8-byte aligned.
+ *
+ * @author James Bayne (jbayne)
+ * @author Drew Cada (aecada2)
+ * @institution North Carolina State University (NCSU)
+ * @course CSC 512
+ * @instructor Xipeng Shen
+ */
+
+#include "fpl_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace {
+
+constexpr char StoreMagic[8] = {'S', 'E', 'M', 'C', 'O', 'L', '1', '\0'};
+constexpr uint64_t BlockRows = 4096;
+
+struct StoreHeader {
+  char magic[8];
+  uint64_t rows;
+  uint64_t columns;
+  uint64_t blockRows;
+};
+
+struct ColumnEntry {
+  uint64_t nameOffset;
+  uint64_t nameLength;
+  double min;
+  double max;
+  uint64_t statsOffset;
+  uint64_t dataOffset;
+};
+
+/** A `column op value` condition on rows. */
+struct Filter {
+  unsigned column;
+  std::string op;
+  double value;
+
+  /** Returns true if a value passes the filter; NaN never does. */
+  bool accepts(double x) const {
+    if (op == "<") {
+      return x < value;
+    }
+    if (op == "<=") {
+      return x <= value;
+    }
+    if (op == ">") {
+      return x > value;
+    }
+    if (op == ">=") {
+      return x >= value;
+    }
+    if (op == "!=") {
+      return x != value && !std::isnan(x);
+    }
+    return x == value;
+  }
+
+  /** Returns true if some value in [min, max] may pass the filter. */
+  bool mayAccept(double min, double max) const {
+    if (std::isnan(min)) {
+      return false;
+    }
+    if (op == "<") {
+      return min < value;
+    }
+    if (op == "<=") {
+      return min <= value;
+    }
+    if (op == ">") {
+      return max > value;
+    }
+    if (op == ">=") {
+      return max >= value;
+    }
+    if (op == "!=") {
+      return !(min == value && max == value);
+    }
+    return min <= value && value <= max;
+  }
+};
+
+/** A mapped store. */
+class Store {
+public:
+  /**
+   * Maps a store and checks its layout.
+   *
+   * @param path The store.
+   * @return False if it is not a valid store.
+   */
+  bool open(const char *path) {
+    if (!file.open(path) || file.length() < sizeof(StoreHeader)) {
+      return false;
+    }
+    header = reinterpret_cast<const StoreHeader *>(file.begin());
+    if (memcmp(header->magic, StoreMagic, sizeof(StoreMagic)) != 0 ||
+        header->blockRows == 0 ||
+        sizeof(StoreHeader) + header->columns * sizeof(ColumnEntry) >
+            file.length()) {
+      return false;
+    }
+    entries = reinterpret_cast<const ColumnEntry *>(header + 1);
+    for (uint64_t i = 0; i < header->columns; ++i) {
+      const ColumnEntry &entry = entries[i];
+      if (entry.nameOffset + entry.nameLength > file.length() ||
+          entry.dataOffset + header->rows * sizeof(double) > file.length() ||
+          entry.statsOffset + blocks() * 2 * sizeof(double) > file.length()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint64_t rows() const { return header->rows; }
+  uint64_t columns() const { return header->columns; }
+  uint64_t blockRows() const { return header->blockRows; }
+  uint64_t blocks() const {
+    return (header->rows + header->blockRows - 1) / header->blockRows;
+  }
+
+  std::string name(unsigned column) const {
+    return std::string(file.begin() + entries[column].nameOffset,
+                       entries[column].nameLength);
+  }
+  const ColumnEntry &entry(unsigned column) const { return entries[column]; }
+  const double *values(unsigned column) const {
+    return reinterpret_cast<const double *>(file.begin() +
+                                            entries[column].dataOffset);
+  }
+  const double *blockStats(unsigned column) const {
+    return reinterpret_cast<const double *>(file.begin() +
+                                            entries[column].statsOffset);
+  }
+
+  /**
+   * Finds a column by name.
+   *
+   * @return The column, or -1 if there is none.
+   */
+  int find(const std::string &column) const {
+    for (uint64_t i = 0; i < header->columns; ++i) {
+      if (name(i) == column) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+private:
+  fpl::MappedFile file;
+  const StoreHeader *header = nullptr;
+  const ColumnEntry *entries = nullptr;
+};
+
+/** Running sums of one column over a set of rows. */
+struct Summary {
+  uint64_t count = 0;
+  double sum = 0;
+  double min = INFINITY;
+  double max = -INFINITY;
+
+  void add(double x) {
+    if (std::isnan(x)) {
+      return;
+    }
+    count++;
+    sum += x;
+    min = std::min(min, x);
+    max = std::max(max, x);
+  }
+};
+
+} // namespace
+
+// ---- HELPER FUNCTIONS ----
+
+/**
+ * Reads the column names of a dataset from `<dataset>.schema`.
+ *
+ * @param dataset The dataset.
+ * @param names The names, in record order.
+ * @return False if the schema cannot be read or is empty.
+ */
+static bool readSchema(const std::string &dataset,
+                       std::vector<std::string> *names) {
+  FILE *schema = fopen((dataset + ".schema").c_str(), "r");
+  if (!schema) {
+    return false;
+  }
+  char line[4096];
+  while (fgets(line, sizeof(line), schema)) {
+    line[strcspn(line, "\n")] = '\0';
+    names->push_back(line);
+  }
+  fclose(schema);
+  return !names->empty();
+}
+
+/** Pads a file with zeros to a multiple of 8 bytes. */
+static void align8(FILE *out) {
+  static const char zeros[8] = {0};
+  long position = ftell(out);
+  fwrite(zeros, 1, (8 - position % 8) % 8, out);
+}
+
+/**
+ * Builds a store from datasets sharing one schema.
+ *
+ * @param path The store to write.
+ * @param datasets The datasets, in row order.
+ * @return The process exit code.
+ */
+static int buildStore(const char *path,
+                      const std::vector<std::string> &datasets) {
+  std::vector<std::string> names;
+  if (!readSchema(datasets[0], &names)) {
+    fprintf(stderr, "Error: Could not read %s.schema.\n",
+            datasets[0].c_str());
+    return 1;
+  }
+  uint64_t recordSize = names.size() * sizeof(double);
+
+  std::vector<std::unique_ptr<fpl::MappedFile>> files;
+  uint64_t rows = 0;
+  for (const std::string &dataset : datasets) {
+    std::vector<std::string> schema;
+    if (!readSchema(dataset, &schema) || schema != names) {
+      fprintf(stderr, "Error: %s does not share the schema of %s.\n",
+              dataset.c_str(), datasets[0].c_str());
+      return 1;
+    }
+    files.push_back(std::make_unique<fpl::MappedFile>());
+    if (!files.back()->open(dataset.c_str())) {
+      fprintf(stderr, "Error: Could not map %s.\n", dataset.c_str());
+      return 1;
+    }
+    if (files.back()->length() % recordSize) {
+      fprintf(stderr, "Warning: %s ends in a partial record.\n",
+              dataset.c_str());
+    }
+    rows += files.back()->length() / recordSize;
+  }
+
+  FILE *out = fopen(path, "wb");
+  if (!out) {
+    fprintf(stderr, "Error: Could not write %s.\n", path);
+    return 1;
+  }
+  StoreHeader header;
+  memcpy(header.magic, StoreMagic, sizeof(StoreMagic));
+  header.rows = rows;
+  header.columns = names.size();
+  header.blockRows = BlockRows;
+  fwrite(&header, sizeof(header), 1, out);
+
+  // The directory is rewritten once the offsets are known
+  std::vector<ColumnEntry> entries(names.size());
+  fwrite(entries.data(), sizeof(ColumnEntry), entries.size(), out);
+  for (size_t i = 0; i < names.size(); ++i) {
+    entries[i].nameOffset = ftell(out);
+    entries[i].nameLength = names[i].size();
+    fwrite(names[i].data(), 1, names[i].size(), out);
+  }
+
+  uint64_t blocks = (rows + BlockRows - 1) / BlockRows;
+  std::vector<double> column(rows);
+  std::vector<double> stats(2 * blocks);
+  for (size_t i = 0; i < names.size(); ++i) {
+    uint64_t row = 0;
+    for (const auto &file : files) {
+      const double *records = reinterpret_cast<const double *>(file->begin());
+      uint64_t count = file->length() / recordSize;
+      for (uint64_t r = 0; r < count; ++r) {
+        column[row++] = records[r * names.size() + i];
+      }
+    }
+
+    Summary all;
+    for (uint64_t b = 0; b < blocks; ++b) {
+      Summary block;
+      for (uint64_t r = b * BlockRows; r < std::min(rows, (b + 1) * BlockRows);
+           ++r) {
+        block.add(column[r]);
+      }
+      stats[2 * b] = block.count ? block.min : NAN;
+      stats[2 * b + 1] = block.count ? block.max : NAN;
+      if (block.count) {
+        all.add(block.min);
+        all.add(block.max);
+      }
+    }
+    entries[i].min = all.count ? all.min : NAN;
+    entries[i].max = all.count ? all.max : NAN;
+
+    align8(out);
+    entries[i].statsOffset = ftell(out);
+    fwrite(stats.data(), sizeof(double), stats.size(), out);
+    entries[i].dataOffset = ftell(out);
+    fwrite(column.data(), sizeof(double), column.size(), out);
+  }
+
+  fseek(out, sizeof(header), SEEK_SET);
+  fwrite(entries.data(), sizeof(ColumnEntry), entries.size(), out);
+  if (fclose(out) != 0) {
+    fprintf(stderr, "Error: Could not write %s.\n", path);
+    return 1;
+  }
+  printf("%llu runs, %zu columns\n", (unsigned long long)rows, names.size());
+  return 0;
+}
+
+/**
+ * Parses a `column op value` filter.
+ *
+ * @param store The store the column is in.
+ * @param text The filter, e.g. `n>=100` or `loop@main:7<10`.
+ * @param filter The parsed filter.
+ * @return False if it is malformed or names an unknown column.
+ */
+static bool parseFilter(const Store &store, const std::string &text,
+                        Filter *filter) {
+  size_t best = text.find_first_of("<>=!");
+  if (best == std::string::npos || best == 0) {
+    return false;
+  }
+  std::string op = text.substr(best, text[best + 1] == '=' ? 2 : 1);
+  if (op == "!") {
+    return false;
+  }
+  int column = store.find(text.substr(0, best));
+  char *end;
+  std::string value = text.substr(best + op.size());
+  filter->value = strtod(value.c_str(), &end);
+  if (column < 0 || value.empty() || *end) {
+    return false;
+  }
+  filter->column = column;
+  filter->op = op == "==" ? "=" : op;
+  return true;
+}
+
+/**
+ * Calls onRow(row) for each row passing every filter, skipping the blocks
+ * whose statistics rule a filter out.
+ */
+template <typename RowFn>
+static void forEachRow(const Store &store, const std::vector<Filter> &filters,
+                       RowFn &&onRow) {
+  for (const Filter &filter : filters) {
+    const ColumnEntry &entry = store.entry(filter.column);
+    if (!filter.mayAccept(entry.min, entry.max)) {
+      return;
+    }
+  }
+  for (uint64_t b = 0; b < store.blocks(); ++b) {
+    bool skip = false;
+    for (const Filter &filter : filters) {
+      const double *stats = store.blockStats(filter.column);
+      skip = skip || !filter.mayAccept(stats[2 * b], stats[2 * b + 1]);
+    }
+    if (skip) {
+      continue;
+    }
+    uint64_t end = std::min(store.rows(), (b + 1) * store.blockRows());
+    for (uint64_t row = b * store.blockRows(); row < end; ++row) {
+      bool accepted = true;
+      for (const Filter &filter : filters) {
+        if (!filter.accepts(store.values(filter.column)[row])) {
+          accepted = false;
+          break;
+        }
+      }
+      if (accepted) {
+        onRow(row);
+      }
+    }
+  }
+}
+
+/**
+ * Resolves a comma-separated list of column names.
+ *
+ * @return False if a column is unknown.
+ */
+static bool parseColumns(const Store &store, const std::string &list,
+                         std::vector<unsigned> *columns) {
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t comma = list.find(',', start);
+    std::string name = list.substr(start, comma - start);
+    int column = store.find(name);
+    if (column < 0) {
+      fprintf(stderr, "Error: Unknown column %s.\n", name.c_str());
+      return false;
+    }
+    columns->push_back(column);
+    if (comma == std::string::npos) {
+      break;
+    }
+    start = comma + 1;
+  }
+  return true;
+}
+
+/** Prints a summary as `count mean min max`. */
+static void printSummary(const Summary &summary) {
+  if (!summary.count) {
+    printf(" 0 nan nan nan");
+    return;
+  }
+  printf(" %llu %.17g %.17g %.17g", (unsigned long long)summary.count,
+         summary.sum / summary.count, summary.min, summary.max);
+}
+
+/**
+ * Runs a query: the rows passing the filters, optionally grouped by the
+ * values of a column, summarized over the selected columns. Rows that never
+ * recorded the grouping column (NaN) form a `nan` group, printed last.
+ */
+static int runQuery(const Store &store, const std::vector<Filter> &filters,
+                    int groupBy, const std::vector<unsigned> &selected) {
+  printf("#%s rows", groupBy >= 0 ? (" " + store.name(groupBy)).c_str() : "");
+  for (unsigned column : selected) {
+    printf(" | %s: count mean min max", store.name(column).c_str());
+  }
+  printf("\n");
+
+  using Group = std::pair<uint64_t, std::vector<Summary>>;
+  std::map<double, Group> groups;
+  Group missing;
+  forEachRow(store, filters, [&](uint64_t row) {
+    double key = groupBy >= 0 ? store.values(groupBy)[row] : 0;
+    Group &group = std::isnan(key) ? missing : groups[key];
+    group.first++;
+    group.second.resize(selected.size());
+    for (size_t i = 0; i < selected.size(); ++i) {
+      group.second[i].add(store.values(selected[i])[row]);
+    }
+  });
+
+  auto printGroup = [&](const char *key, const Group &group) {
+    if (groupBy >= 0) {
+      printf("%s ", key);
+    }
+    printf("%llu", (unsigned long long)group.first);
+    for (const Summary &summary : group.second) {
+      printSummary(summary);
+    }
+    printf("\n");
+  };
+  for (const auto &[key, group] : groups) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.17g", key);
+    printGroup(text, group);
+  }
+  if (missing.first) {
+    printGroup("nan", missing);
+  }
+  return 0;
+}
+
+/**
+ * Prints the Pearson correlation of two columns over the rows passing the
+ * filters, and the least-squares line `y = slope * x + intercept`.
+ */
+static int runCorrelation(const Store &store,
+                          const std::vector<Filter> &filters, unsigned x,
+                          unsigned y) {
+  uint64_t n = 0;
+  double sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+  forEachRow(store, filters, [&](uint64_t row) {
+    double a = store.values(x)[row], b = store.values(y)[row];
+    if (std::isnan(a) || std::isnan(b)) {
+      return;
+    }
+    n++;
+    sx += a;
+    sy += b;
+    sxx += a * a;
+    syy += b * b;
+    sxy += a * b;
+  });
+  double cov = n * sxy - sx * sy;
+  double vx = n * sxx - sx * sx, vy = n * syy - sy * sy;
+  double slope = vx > 0 ? cov / vx : NAN;
+  printf("rows %llu\n", (unsigned long long)n);
+  printf("pearson %.6g\n", vx > 0 && vy > 0 ? cov / std::sqrt(vx * vy) : NAN);
+  printf("slope %.17g\n", slope);
+  printf("intercept %.17g\n", n ? (sy - slope * sx) / n : NAN);
+  return 0;
+}
+
+/** Prints the usage of the tool. */
+static int usage(const char *tool) {
+  fprintf(stderr,
+          "Usage: %s build -o <store> <dataset>...\n"
+          "       %s columns <store>\n"
+          "       %s query <store> [-w <col><op><value>]... [-g <col>] "
+          "[-s <col>,...]\n"
+          "       %s corr <store> <col> <col> [-w <col><op><value>]...\n",
+          tool, tool, tool, tool);
+  return 1;
+}
+
+// ---- END HELPER FUNCTIONS ----
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    return usage(argv[0]);
+  }
+  std::string command = argv[1];
+
+  if (command == "build") {
+    const char *path = nullptr;
+    std::vector<std::string> datasets;
+    for (int i = 2; i < argc; ++i) {
+      if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+        path = argv[++i];
+      } else {
+        datasets.push_back(argv[i]);
+      }
+    }
+    if (!path || datasets.empty()) {
+      return usage(argv[0]);
+    }
+    return buildStore(path, datasets);
+  }
+
+  Store store;
+  if (!store.open(argv[2])) {
+    fprintf(stderr, "Error: %s is not a profile store.\n", argv[2]);
+    return 1;
+  }
+
+  if (command == "columns") {
+    for (uint64_t i = 0; i < store.columns(); ++i) {
+      printf("%s %.17g %.17g\n", store.name(i).c_str(), store.entry(i).min,
+             store.entry(i).max);
+    }
+    return 0;
+  }
+
+  std::vector<Filter> filters;
+  std::vector<unsigned> selected;
+  std::vector<std::string> positional;
+  int groupBy = -1;
+  for (int i = 3; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-w" && i + 1 < argc) {
+      Filter filter;
+      if (!parseFilter(store, argv[++i], &filter)) {
+        fprintf(stderr, "Error: Bad filter %s.\n", argv[i]);
+        return 1;
+      }
+      filters.push_back(filter);
+    } else if (arg == "-g" && i + 1 < argc) {
+      groupBy = store.find(argv[++i]);
+      if (groupBy < 0) {
+        fprintf(stderr, "Error: Unknown column %s.\n", argv[i]);
+        return 1;
+      }
+    } else if (arg == "-s" && i + 1 < argc) {
+      if (!parseColumns(store, argv[++i], &selected)) {
+        return 1;
+      }
+    } else {
+      positional.push_back(arg);
+    }
+  }
+
+  if (command == "query" && positional.empty()) {
+    return runQuery(store, filters, groupBy, selected);
+  }
+  if (command == "corr" && positional.size() == 2) {
+    int x = store.find(positional[0]), y = store.find(positional[1]);
+    if (x < 0 || y < 0) {
+      fprintf(stderr, "Error: Unknown column %s.\n",
+              (x < 0 ? positional[0] : positional[1]).c_str());
+      return 1;
+    }
+    return runCorrelation(store, filters, x, y);
+  }
+  return usage(argv[0]);
+}